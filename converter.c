@@ -0,0 +1,71 @@
+/**
+ * @file converter.c
+ * @author Aleksandar Hadzhiyski <e1426981@student.tuwien.ac.at>
+ * @date 21.11.2020
+ *  
+ * @brief Converter program module.
+ * @details The converter module reads a graph from a text input in any of the supported
+ * formats and writes it as a binary graph file. The binary graph file holds the
+ * finalized graph along with its vertex labels, so that generators can map it and
+ * start searching without parsing the graph or building it again.
+ * 
+ * USAGE: The converter takes the input file ("-" denoting stdin) and the output file
+ * ("-" denoting stdout).
+ * converter [-t FORMAT] INPUT OUTPUT
+ */
+
+#include "fb_arc_set.h"
+
+/**
+ * Program entry point.
+ * @brief This is the main program of the converter module.
+ * @details The program reads and builds the graph with graph_read() and writes it with
+ * graph_write_fasg(). A summary of the written graph is printed to stdout, unless the
+ * binary graph file itself is written to stdout.
+ * @param argc The argument counter.
+ * @param argv The argument vector.
+ * @return Returns EXIT_SUCCESS.
+ */
+int main(int argc, char *argv[])
+{
+    char *prog = argv[0];
+    int opt;
+    Graph_format fmt = FORMAT_AUTO;
+
+    while ((opt = getopt(argc, argv, "t:")) != -1)
+    {
+        switch (opt)
+        {
+        case 't':
+            if (!format_from_name(optarg, &fmt))
+                usage(prog);
+            break;
+        default:
+            usage(prog);
+        }
+    }
+
+    if (argc - optind != 2)
+    {
+        usage(prog);
+    }
+
+    char *input = argv[optind];
+    char *output = argv[optind + 1];
+
+    Label_map *labels;
+    Input_stats stats;
+    Graph_ptr g = graph_read(input, fmt, &labels, &stats);
+
+    graph_write_fasg(g, labels, output);
+
+    if (strcmp(output, "-") != 0)
+    {
+        fprintf(stdout, "[%s] Wrote %d vertices and %d edges to %s (fingerprint %016" PRIx64 ")\n",
+                prog, graph_vertex_count(g), graph_edge_count(g), output, graph_fingerprint(g, labels));
+    }
+
+    label_map_destroy(labels);
+    graph_destroy(g);
+    exit(EXIT_SUCCESS);
+}
@@ -23,12 +23,17 @@ void usage(char *prog)
 
     if (strcmp(prog, "./generator") == 0)
     {
-        fprintf(stderr, "Usage: %s EDGE1 EDGE2...\n", prog);
+        fprintf(stderr, "Usage: %s [--stats] [--threads N] [-t auto|edges|dimacs|metis|fasg] [-f FILE | EDGE1 EDGE2...]\n", prog);
+        exit(EXIT_FAILURE);
+    }
+    else if (strcmp(prog, "./converter") == 0)
+    {
+        fprintf(stderr, "Usage: %s [-t auto|edges|dimacs|metis] INPUT OUTPUT\n", prog);
         exit(EXIT_FAILURE);
     }
     else if (strcmp(prog, "./supervisor") == 0)
     {
-        fprintf(stderr, "Usage: %s takes no arguments!\n", prog);
+        fprintf(stderr, "Usage: %s [--query] [--channels N] [--ring-slots N] [--seed S] [-t auto|edges|dimacs|metis|fasg] [-f FILE]\n", prog);
         exit(EXIT_FAILURE);
     }
     else
@@ -43,88 +48,139 @@ int cmpfunc(const void *a, const void *b)
     return (*(int *)a - *(int *)b);
 }
 
-int val_in_arr(int val, int *arr, size_t size)
+int cmp_label(const void *a, const void *b)
 {
-    for (int i = 0; i < size; i++)
-    {
-        if (arr[i] == val)
-            return 1;
-    }
-    return 0;
+    Label x = *(const Label *)a;
+    Label y = *(const Label *)b;
+
+    return (x > y) - (x < y);
 }
 
-int src_from_arg(char *arg)
+double elapsed_ms(const struct timespec *start)
 {
-    int i, n;
-    n = 0;
+    struct timespec now;
 
-    for (i = 0; arg[i] >= '0' && arg[i] <= '9' && arg[i] != '-'; ++i)
-        n = 10 * n + (arg[i] - '0');
-    return n;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1e3 + (now.tv_nsec - start->tv_nsec) / 1e6;
 }
 
-int trgt_from_arg(char *arg)
+void print_solution(Label_edge edge_set[], char *prog, int size, int writer)
 {
-    int i, n;
-    n = i = 0;
-
-    while (arg[i] != '-')
-        ++i;
-    ++i;
-
-    for (; arg[i] >= '0' && arg[i] <= '9' && arg[i] != '\0'; i++)
-        n = 10 * n + (arg[i] - '0');
-    return n;
+    fprintf(stdout, "[%s] Solution with %d edges from generator %d:", prog, size, writer);
+    for (int i = 0; i < size; ++i)
+        fprintf(stdout, " %" PRIu64 "-%" PRIu64, edge_set[i].src, edge_set[i].trgt);
+    fprintf(stdout, "\n");
 }
 
 /**
- * @details The function makes use of regex to assert the correct edge format.
+ * ---------------------------------------------------------------------------------
+ *                    Random number generator functions implementations
+ * ---------------------------------------------------------------------------------
  */
-int assert_edge_format(char *arg)
+
+uint64_t stream_seed(uint64_t master, uint64_t stream)
+{
+    uint64_t z = master + (stream + 1) * 0x9e3779b97f4a7c15ULL;
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void rng_seed(Rng *rng, uint64_t seed)
+{
+    for (int i = 0; i < 4; i++)
+        rng->s[i] = stream_seed(seed, i);
+}
+
+static inline uint64_t rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+uint64_t rng_next(Rng *rng)
 {
-    int val;
-    regex_t regex;
-    int reti = regcomp(&regex, "[0-9]-[0-9]", REG_EXTENDED);
-    if (reti != 0)
+    uint64_t *s = rng->s;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+
+    return result;
+}
+
+void rng_jump(Rng *rng)
+{
+    static const uint64_t jump[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                    0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+    uint64_t s[4] = {0, 0, 0, 0};
+
+    for (int i = 0; i < 4; i++)
     {
-        fprintf(stderr, "Edge argument formatting cannot be asserted due to REGEX compilation failure!\n");
-        exit(EXIT_FAILURE);
+        for (int b = 0; b < 64; b++)
+        {
+            if (jump[i] & (1ULL << b))
+            {
+                for (int j = 0; j < 4; j++)
+                    s[j] ^= rng->s[j];
+            }
+            rng_next(rng);
+        }
     }
-    val = regexec(&regex, arg, 0, NULL, 0);
-    if (val == REG_NOMATCH)
-        return 0;
-    return 1;
+    memcpy(rng->s, s, sizeof(s));
 }
 
-int generate_random(int lower, int upper)
+uint32_t rng_bounded(Rng *rng, uint32_t range)
 {
-    return ((rand() % (upper - lower + 1)) + lower);
+    uint64_t m = (rng_next(rng) >> 32) * range;
+    uint32_t low = (uint32_t)m;
+
+    /**
+     * Only if the low half falls below the range the result may be biased, which is
+     * settled by the threshold 2^32 mod range.
+     */
+    if (low < range)
+    {
+        uint32_t threshold = -range % range;
+        while (low < threshold)
+        {
+            m = (rng_next(rng) >> 32) * range;
+            low = (uint32_t)m;
+        }
+    }
+    return m >> 32;
 }
 
 /**
  * @details The function iterates through the elements in the array and swaps an element
- * with another one which is positioned after the first element.
+ * with another one which is positioned after the first element. The positions of a
+ * batch are drawn first, so that the generator runs in a tight loop of its own.
  */
-void shuffle_vertex_set(int *set, size_t size)
+void shuffle_vertex_set(int *set, size_t size, Rng *rng)
 {
+    uint32_t pos[RNG_BATCH];
+    size_t i, k, n;
+    int temp;
 
-    int rand_pos, temp, i;
-
-    for (i = 0; i < size; i++)
+    for (i = 0; i + 1 < size; i += n)
     {
-        rand_pos = generate_random(i, size - 1);
-        temp = set[i];
-        set[i] = set[rand_pos];
-        set[rand_pos] = temp;
-    }
-}
+        n = size - 1 - i < RNG_BATCH ? size - 1 - i : RNG_BATCH;
 
-void print_solution(Edge edge_set[], char *prog, int size)
-{
-    fprintf(stdout, "[%s] Solution with %d edges:", prog, size);
-    for (int i = 0; i < size; ++i)
-        fprintf(stdout, " %d-%d", edge_set[i].src, edge_set[i].trgt);
-    fprintf(stdout, "\n");
+        for (k = 0; k < n; k++)
+            pos[k] = i + k + rng_bounded(rng, size - i - k);
+
+        for (k = 0; k < n; k++)
+        {
+            temp = set[i + k];
+            set[i + k] = set[pos[k]];
+            set[pos[k]] = temp;
+        }
+    }
 }
 
 /** 
@@ -139,55 +195,162 @@ void print_solution(Edge edge_set[], char *prog, int size)
 Graph_ptr graph_create(int n)
 {
     Graph_ptr g;
-    int i;
 
-    g = malloc(sizeof(struct Graph_s) + sizeof(struct successors *) * (n - 1));
+    g = malloc(sizeof(struct Graph_s));
     assert(g);
 
     g->V = n;
     g->E = 0;
+    g->is_final = false;
 
-    for (i = 0; i < n; i++)
-    {
-        g->alist[i] = malloc(sizeof(struct successors));
-        assert(g->alist[i]);
+    g->cap = 1;
+    g->staged = malloc(sizeof(Edge) * g->cap);
+    assert(g->staged);
 
-        g->alist[i]->d = 0;
-        g->alist[i]->len = 1;
-        g->alist[i]->is_sorted = true;
-    }
+    g->offsets = NULL;
+    g->targets = NULL;
+
+    g->max_out = 0;
+    g->max_in = 0;
+    g->dup_edges = 0;
+
+    g->mapping = NULL;
+    g->map_size = 0;
 
     return g;
 }
 
 void graph_destroy(Graph_ptr g)
 {
-    int i;
-
-    for (i = 0; i < g->V; i++)
-        free(g->alist[i]);
+    if (g->mapping != NULL)
+    {
+        munmap(g->mapping, g->map_size);
+    }
+    else
+    {
+        free(g->offsets);
+        free(g->targets);
+    }
+    free(g->staged);
     free(g);
 }
 
 void graph_add_edge(Graph_ptr g, int u, int v)
 {
+    assert(!g->is_final);
     assert(u >= 0);
     assert(u < g->V);
     assert(v >= 0);
     assert(v < g->V);
 
-    while (g->alist[u]->d >= g->alist[u]->len)
+    if (g->E >= g->cap)
     {
-        g->alist[u]->len *= 2;
-        g->alist[u] = realloc(g->alist[u], sizeof(struct successors) + sizeof(int) * (g->alist[u]->len - 1));
+        g->cap *= 2;
+        g->staged = realloc(g->staged, sizeof(Edge) * g->cap);
+        assert(g->staged);
     }
 
-    g->alist[u]->list[g->alist[u]->d++] = v;
-    g->alist[u]->is_sorted = false;
+    g->staged[g->E].src = u;
+    g->staged[g->E].trgt = v;
 
     g->E++;
 }
 
+/**
+ * @details The successor arrays are built by two counting sort passes over the staged
+ * edges: the sources are first grouped by target and then placed into their rows while
+ * visiting the targets in ascending order, so that every row ends up sorted in linear
+ * time. The rows are then compacted in place to drop duplicate edges and the degree
+ * statistics are recorded.
+ */
+void graph_finalize(Graph_ptr g)
+{
+    int i, u, t, w, start;
+    int *fill, *in_offsets, *by_trgt;
+
+    assert(!g->is_final);
+
+    g->offsets = calloc(g->V + 1, sizeof(int));
+    g->targets = malloc(sizeof(int) * (g->E > 0 ? g->E : 1));
+    in_offsets = calloc(g->V + 1, sizeof(int));
+    by_trgt = malloc(sizeof(int) * (g->E > 0 ? g->E : 1));
+    fill = malloc(sizeof(int) * (g->V > 0 ? g->V : 1));
+    assert(g->offsets && g->targets && in_offsets && by_trgt && fill);
+
+    for (i = 0; i < g->E; i++)
+    {
+        g->offsets[g->staged[i].src + 1]++;
+        in_offsets[g->staged[i].trgt + 1]++;
+    }
+
+    for (u = 0; u < g->V; u++)
+    {
+        in_offsets[u + 1] += in_offsets[u];
+        fill[u] = in_offsets[u];
+    }
+
+    for (i = 0; i < g->E; i++)
+        by_trgt[fill[g->staged[i].trgt]++] = g->staged[i].src;
+
+    for (u = 0; u < g->V; u++)
+    {
+        g->offsets[u + 1] += g->offsets[u];
+        fill[u] = g->offsets[u];
+    }
+
+    for (t = 0; t < g->V; t++)
+    {
+        for (i = in_offsets[t]; i < in_offsets[t + 1]; i++)
+            g->targets[fill[by_trgt[i]]++] = t;
+    }
+
+    free(by_trgt);
+    free(in_offsets);
+    free(g->staged);
+    g->staged = NULL;
+    g->cap = 0;
+
+    /**
+     * the rows are sorted, hence duplicate edges are adjacent and can be dropped by
+     * moving every row to the front, keeping only the first of each run of targets
+     */
+    g->max_out = 0;
+    for (u = 0, w = 0; u < g->V; u++)
+    {
+        start = g->offsets[u];
+        g->offsets[u] = w;
+
+        for (i = start; i < g->offsets[u + 1]; i++)
+        {
+            if (w == g->offsets[u] || g->targets[w - 1] != g->targets[i])
+                g->targets[w++] = g->targets[i];
+        }
+
+        if (w - g->offsets[u] > g->max_out)
+            g->max_out = w - g->offsets[u];
+    }
+    g->offsets[g->V] = w;
+
+    g->dup_edges = g->E - w;
+    g->E = w;
+    if (g->dup_edges > 0 && w > 0)
+    {
+        g->targets = realloc(g->targets, sizeof(int) * w);
+        assert(g->targets);
+    }
+
+    memset(fill, 0, sizeof(int) * g->V);
+    g->max_in = 0;
+    for (i = 0; i < g->E; i++)
+    {
+        if (++fill[g->targets[i]] > g->max_in)
+            g->max_in = fill[g->targets[i]];
+    }
+    free(fill);
+
+    g->is_final = true;
+}
+
 int graph_vertex_count(Graph_ptr g)
 {
     return g->V;
@@ -198,27 +361,44 @@ int graph_edge_count(Graph_ptr g)
     return g->E;
 }
 
+int graph_max_out_degree(Graph_ptr g)
+{
+    assert(g->is_final);
+
+    return g->max_out;
+}
+
+int graph_max_in_degree(Graph_ptr g)
+{
+    assert(g->is_final);
+
+    return g->max_in;
+}
+
 int graph_out_degree(Graph_ptr g, int source)
 {
+    assert(g->is_final);
     assert(source >= 0);
     assert(source < g->V);
 
-    return g->alist[source]->d;
+    return g->offsets[source + 1] - g->offsets[source];
 }
 
 int graph_has_edge(Graph_ptr g, int source, int target)
 {
-    int i;
+    int i, d;
+    const int *succ;
+
+    succ = graph_successors(g, source);
+    d = graph_out_degree(g, source);
 
-    if (graph_out_degree(g, source) >= BSEARCH_PROMPT_SIZE)
+    if (d >= BSEARCH_PROMPT_SIZE)
     {
         /** 
          * in case the source has too many neighbors, instead of doing a linear search,
-         * first sort the adjacency list and after that, use the built-in binary search
+         * use the built-in binary search on the row which was sorted by graph_finalize()
          */
-        if (!g->alist[source]->is_sorted)
-            qsort(g->alist[source]->list, g->alist[source]->d, sizeof(int), cmpfunc);
-        return bsearch(&target, g->alist[source]->list, g->alist[source]->d, sizeof(int), cmpfunc) != 0;
+        return bsearch(&target, succ, d, sizeof(int), cmpfunc) != 0;
     }
     else
     {
@@ -226,88 +406,1706 @@ int graph_has_edge(Graph_ptr g, int source, int target)
          * for a small enough number of neighbors, we can simply not bother to optimize searching,
          * instead do a straight-forward linear comparison search
          */
-        for (i = 0; i < g->alist[source]->d; i++)
+        for (i = 0; i < d && succ[i] <= target; i++)
         {
-            if (g->alist[source]->list[i] == target)
+            if (succ[i] == target)
                 return 1;
         }
         return 0;
     }
 }
 
+const int *graph_successors(Graph_ptr g, int source)
+{
+    assert(source >= 0);
+    assert(source < g->V);
+
+    return g->targets + g->offsets[source];
+}
+
+int graph_acyclic_order(Graph_ptr g, const Edge removed[], int num_removed, int *order)
+{
+    int u, v, i, d, head, tail;
+    const int *succ;
+    const int *hit;
+
+    bool *gone = calloc(g->E > 0 ? g->E : 1, sizeof(bool));
+    int *in_deg = calloc(g->V > 0 ? g->V : 1, sizeof(int));
+    assert(gone && in_deg);
+
+    for (i = 0; i < num_removed; i++)
+    {
+        u = removed[i].src;
+        succ = graph_successors(g, u);
+        hit = bsearch(&removed[i].trgt, succ, graph_out_degree(g, u), sizeof(int), cmpfunc);
+        if (hit != NULL)
+            gone[hit - g->targets] = true;
+    }
+
+    for (i = 0; i < g->E; i++)
+    {
+        if (!gone[i])
+            in_deg[g->targets[i]]++;
+    }
+
+    /**
+     * The ordering itself serves as queue of the vertices without predecessors left.
+     */
+    tail = 0;
+    for (u = 0; u < g->V; u++)
+    {
+        if (in_deg[u] == 0)
+            order[tail++] = u;
+    }
+
+    for (head = 0; head < tail; head++)
+    {
+        u = order[head];
+        succ = graph_successors(g, u);
+        d = graph_out_degree(g, u);
+
+        for (i = 0; i < d; i++)
+        {
+            v = succ[i];
+            if (!gone[&succ[i] - g->targets] && --in_deg[v] == 0)
+                order[tail++] = v;
+        }
+    }
+
+    free(gone);
+    free(in_deg);
+    return tail;
+}
+
 /**
- * ---------------------------------------------------------------------------------
- *                          Semaphore functions implementations                      
- * ---------------------------------------------------------------------------------
+ * @details Besides its index and low link, every vertex is marked by its component:
+ * -2 while it hasn't been assigned one, which for an indexed vertex means that it is
+ * still on the stack of Tarjan's algorithm. The call stack of the recursive algorithm
+ * is replaced by the vertices and the next successor to be visited of each.
  */
+Graph_scc *graph_scc_create(Graph_ptr g)
+{
+    int s, u, v, i, top, sp, counter, start;
+
+    assert(g->is_final);
+
+    Graph_scc *scc = malloc(sizeof(Graph_scc));
+    int *index = malloc(sizeof(int) * (g->V > 0 ? g->V : 1));
+    int *low = malloc(sizeof(int) * (g->V > 0 ? g->V : 1));
+    int *stack = malloc(sizeof(int) * (g->V > 0 ? g->V : 1));
+    int *call = malloc(sizeof(int) * (g->V > 0 ? g->V : 1));
+    int *next = malloc(sizeof(int) * (g->V > 0 ? g->V : 1));
+    assert(scc && index && low && stack && call && next);
+
+    scc->comp = malloc(sizeof(int) * (g->V > 0 ? g->V : 1));
+    scc->vertices = malloc(sizeof(int) * (g->V > 0 ? g->V : 1));
+    scc->offsets = malloc(sizeof(int) * (g->V / 2 + 1));
+    assert(scc->comp && scc->vertices && scc->offsets);
+
+    for (u = 0; u < g->V; u++)
+    {
+        index[u] = -1;
+        scc->comp[u] = -2;
+    }
+
+    scc->count = 0;
+    scc->size = 0;
+    scc->offsets[0] = 0;
+    counter = 0;
+    sp = 0;
+
+    for (s = 0; s < g->V; s++)
+    {
+        if (index[s] != -1)
+            continue;
+
+        top = 0;
+        call[0] = s;
+        next[0] = g->offsets[s];
+        index[s] = low[s] = counter++;
+        stack[sp++] = s;
+
+        while (top >= 0)
+        {
+            u = call[top];
+
+            if (next[top] < g->offsets[u + 1])
+            {
+                v = g->targets[next[top]++];
+                if (index[v] == -1)
+                {
+                    ++top;
+                    call[top] = v;
+                    next[top] = g->offsets[v];
+                    index[v] = low[v] = counter++;
+                    stack[sp++] = v;
+                }
+                else if (scc->comp[v] == -2 && index[v] < low[u])
+                    low[u] = index[v];
+                continue;
+            }
+
+            if (--top >= 0 && low[u] < low[call[top]])
+                low[call[top]] = low[u];
+
+            if (low[u] != index[u])
+                continue;
+
+            /**
+             * u is the root of a component, which consists of the vertices on the stack
+             * from u upwards.
+             */
+            for (start = sp - 1; stack[start] != u; start--)
+                ;
+
+            if (sp - start == 1)
+                scc->comp[u] = -1;
+            else
+            {
+                for (i = start; i < sp; i++)
+                {
+                    scc->comp[stack[i]] = scc->count;
+                    scc->vertices[scc->size++] = stack[i];
+                }
+                scc->offsets[++scc->count] = scc->size;
+            }
+            sp = start;
+        }
+    }
+
+    scc->edge_offsets = calloc(scc->count + 1, sizeof(int));
+    assert(scc->edge_offsets);
+
+    for (u = 0; u < g->V; u++)
+    {
+        if (scc->comp[u] < 0)
+            continue;
+        for (i = g->offsets[u]; i < g->offsets[u + 1]; i++)
+        {
+            if (g->targets[i] != u && scc->comp[g->targets[i]] == scc->comp[u])
+                scc->edge_offsets[scc->comp[u] + 1]++;
+        }
+    }
+    for (i = 0; i < scc->count; i++)
+        scc->edge_offsets[i + 1] += scc->edge_offsets[i];
 
-sem_t *open_sem(char *sem_name, size_t sem_size, int mode)
+    free(index);
+    free(low);
+    free(stack);
+    free(call);
+    free(next);
+    return scc;
+}
+
+void graph_scc_destroy(Graph_scc *scc)
 {
-    sem_t *sem;
+    free(scc->offsets);
+    free(scc->vertices);
+    free(scc->edge_offsets);
+    free(scc->comp);
+    free(scc);
+}
 
-    if (mode == 0)
-        sem = sem_open(sem_name, O_CREAT | O_EXCL, 0600, sem_size);
-    else
-        sem = sem_open(sem_name, sem_size);
+/**
+ * @details The positions of the vertices of the component are written over on each
+ * call, hence the same position array can be reused between evaluations without
+ * clearing it.
+ */
+int graph_component_fb_set(Graph_ptr g, const Graph_scc *scc, int c, const int *order, int *pos, Edge fb_set[], int bound)
+{
+    int n = scc->offsets[c + 1] - scc->offsets[c];
+    int u, v, i, j, size;
+
+    for (i = 0; i < n; i++)
+        pos[order[i]] = i;
 
-    if (sem == SEM_FAILED)
+    size = 0;
+    for (i = 0; i < n; i++)
     {
-        fprintf(stderr, "ERROR: Semaphore creation failed!\n");
-        exit(EXIT_FAILURE);
+        u = order[i];
+        for (j = g->offsets[u]; j < g->offsets[u + 1]; j++)
+        {
+            v = g->targets[j];
+            if (scc->comp[v] == c && pos[v] < i)
+            {
+                if (size >= bound)
+                    return bound;
+                fb_set[size].src = u;
+                fb_set[size].trgt = v;
+                ++size;
+            }
+        }
     }
-    return sem;
+    return size;
 }
 
-void getval_sem(sem_t *sem, int *res)
+int graph_component_exact_fb_set(Graph_ptr g, const Graph_scc *scc, int c, Edge fb_set[])
 {
-    if (sem_getvalue(sem, res) == -1)
+    const int *verts = scc->vertices + scc->offsets[c];
+    int n = scc->offsets[c + 1] - scc->offsets[c];
+    uint32_t succ[EXACT_MAX_VERTICES];
+    uint32_t set, rest, full;
+    int i, j, k, v, cost, size;
+
+    assert(n <= EXACT_MAX_VERTICES);
+
+    /**
+     * The successors inside the component as bit masks of their local indices.
+     */
+    for (i = 0; i < n; i++)
     {
-        fprintf(stderr, "ERROR: Semaphore value fetch failed!\n");
-        exit(EXIT_FAILURE);
+        succ[i] = 0;
+        for (j = g->offsets[verts[i]]; j < g->offsets[verts[i] + 1]; j++)
+        {
+            for (k = 0; k < n; k++)
+            {
+                if (verts[k] == g->targets[j] && k != i)
+                    succ[i] |= (uint32_t)1 << k;
+            }
+        }
+    }
+
+    full = ((uint32_t)1 << n) - 1;
+    uint8_t *best = malloc(full + 1);
+    uint8_t *last = malloc(full + 1);
+    assert(best && last);
+
+    best[0] = 0;
+    for (set = 1; set <= full; set++)
+    {
+        best[set] = UINT8_MAX;
+        for (i = 0; i < n; i++)
+        {
+            if (!(set & ((uint32_t)1 << i)))
+                continue;
+            rest = set & ~((uint32_t)1 << i);
+            cost = best[rest] + __builtin_popcount(succ[i] & rest);
+            if (cost < best[set])
+            {
+                best[set] = cost;
+                last[set] = i;
+            }
+        }
+    }
+
+    /**
+     * The ordering is rebuilt from its end, the backward edges of each vertex are those
+     * to the vertices placed before it.
+     */
+    size = 0;
+    for (set = full; set != 0; set &= ~((uint32_t)1 << v))
+    {
+        v = last[set];
+        rest = set & ~((uint32_t)1 << v);
+        for (k = 0; k < n; k++)
+        {
+            if (succ[v] & rest & ((uint32_t)1 << k))
+            {
+                fb_set[size].src = verts[v];
+                fb_set[size].trgt = verts[k];
+                ++size;
+            }
+        }
     }
+
+    free(best);
+    free(last);
+    return size;
+}
+
+/** 
+ * ---------------------------------------------------------------------------------
+ *                              Graph input functions implementations
+ * ---------------------------------------------------------------------------------
+ */
+
+void edge_list_init(Edge_list *list)
+{
+    list->num_e = 0;
+    list->cap = 16;
+    list->edges = malloc(sizeof(Label_edge) * list->cap);
+    assert(list->edges);
 }
 
-void wait_sem(sem_t *sem)
+void edge_list_push(Edge_list *list, Label src, Label trgt)
 {
-    if (sem_wait(sem) == -1)
+    if (list->num_e >= list->cap)
     {
-        if (errno == EINTR)
-            return;
-        fprintf(stderr, "ERROR: Semaphore decrement/lock failed!\n");
-        exit(EXIT_FAILURE);
+        list->cap *= 2;
+        list->edges = realloc(list->edges, sizeof(Label_edge) * list->cap);
+        assert(list->edges);
     }
+
+    list->edges[list->num_e].src = src;
+    list->edges[list->num_e].trgt = trgt;
+    list->num_e++;
+}
+
+void edge_list_free(Edge_list *list)
+{
+    free(list->edges);
+    list->edges = NULL;
+    list->num_e = 0;
+    list->cap = 0;
 }
 
-void post_sem(sem_t *sem)
+int format_from_name(const char *name, Graph_format *fmt)
 {
-    if (sem_post(sem) == -1)
+    if (strcmp(name, "auto") == 0)
+        *fmt = FORMAT_AUTO;
+    else if (strcmp(name, "edges") == 0)
+        *fmt = FORMAT_EDGES;
+    else if (strcmp(name, "dimacs") == 0)
+        *fmt = FORMAT_DIMACS;
+    else if (strcmp(name, "metis") == 0)
+        *fmt = FORMAT_METIS;
+    else if (strcmp(name, "fasg") == 0)
+        *fmt = FORMAT_FASG;
+    else
+        return 0;
+    return 1;
+}
+
+/**
+ * Skip blanks function.
+ * @brief This function skips the spaces, tabs and carriage returns of a line.
+ * @param p Pointer into a line.
+ * @param end Pointer past the last character of the line.
+ * @return Returns a pointer to the first character which isn't a blank, or end.
+ */
+static const char *skip_blanks(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        ++p;
+    return p;
+}
+
+/**
+ * Parse label function.
+ * @brief This function parses a decimal vertex label and advances past it.
+ * @details Up to 19 digits always fit into a Label, hence the overflow check is only
+ * performed from the 20th digit on and the loop otherwise consists of one comparison
+ * and one multiply-add per digit.
+ * @param p Pointer to a pointer into a line, advanced past the digits on success.
+ * @param end Pointer past the last character of the line.
+ * @param label Pointer to the Label receiving the parsed value.
+ * @return Returns 1 if a label was parsed, 0 if there are no digits or the value overflows.
+ */
+static int parse_label(const char **p, const char *end, Label *label)
+{
+    const char *q = *p;
+    Label n = 0;
+    unsigned digit;
+
+    for (; q < end && (digit = (unsigned char)*q - '0') < 10; ++q)
     {
-        fprintf(stderr, "ERROR: Semaphore increment/unlock failed!\n");
-        exit(EXIT_FAILURE);
+        if (q - *p >= 19 && n > (UINT64_MAX - digit) / 10)
+            return 0;
+        n = 10 * n + digit;
     }
+
+    if (q == *p)
+        return 0;
+
+    *p = q;
+    *label = n;
+    return 1;
 }
 
-void close_sem(sem_t *sem)
+/**
+ * Format name function.
+ * @brief This function gives the name of a Graph_format for error messages.
+ * @param fmt Graph_format.
+ * @return Returns the name of the format.
+ */
+static const char *format_name(Graph_format fmt)
 {
-    if (sem_close(sem) == -1)
+    switch (fmt)
     {
-        fprintf(stderr, "ERROR: Semaphore closing failed!\n");
-        exit(EXIT_FAILURE);
+    case FORMAT_DIMACS:
+        return "DIMACS";
+    case FORMAT_METIS:
+        return "METIS";
+    default:
+        return "edge list";
     }
 }
 
 /**
- * ---------------------------------------------------------------------------------
- *                       Shared memory functions implementations                     
- * ---------------------------------------------------------------------------------
+ * Line format function.
+ * @brief This function detects the input format from a line.
+ * @param p Pointer to the first non-blank character of the line.
+ * @param end Pointer past the last character of the line.
+ * @return Returns FORMAT_AUTO for empty and comment lines, FORMAT_DIMACS for lines
+ * starting with 'a', 'c' or 'p' and FORMAT_EDGES otherwise.
  */
+static Graph_format line_format(const char *p, const char *end)
+{
+    if (p == end || *p == '#' || *p == '%')
+        return FORMAT_AUTO;
+    return (*p == 'a' || *p == 'c' || *p == 'p') ? FORMAT_DIMACS : FORMAT_EDGES;
+}
 
-int create_shm(char *shm_name)
+/**
+ * Parse line function.
+ * @brief This function parses one input line and appends its edges to an Edge_list.
+ * @details Empty lines and lines starting with '#' or '%' are skipped in the edge list
+ * format, DIMACS comment ("c") and problem ("p") lines are skipped as well and anything
+ * after the target of an arc (e.g. a weight) is ignored. The METIS header
+ * "<n> <m> [fmt [ncon]]" must precede the n adjacency lines; vertex sizes, vertex weights
+ * and edge weights announced by fmt are skipped. With FORMAT_AUTO, the format of the
+ * parser is set by the first line which isn't empty or a comment.
+ * @param parser Pointer to the Input_parser struct holding the format and METIS state.
+ * @param p Pointer to the first character of the line.
+ * @param end Pointer past the last character of the line, excluding the newline.
+ * @param list Pointer to the Edge_list the edges are appended to.
+ * @return Returns 1 if the line is well-formed, 0 otherwise.
+ */
+static int parse_line(Input_parser *parser, const char *p, const char *end, Edge_list *list)
 {
-    int shm_fd = shm_open(shm_name, O_RDWR | O_CREAT, 0600);
-    if (shm_fd == -1)
+    Label src, trgt, value, i;
+
+    p = skip_blanks(p, end);
+
+    if (parser->fmt == FORMAT_AUTO)
     {
-        fprintf(stderr, "ERROR: Shared memory object creation failed!\n");
+        parser->fmt = line_format(p, end);
+        if (parser->fmt == FORMAT_AUTO)
+            return 1;
+    }
+
+    switch (parser->fmt)
+    {
+    case FORMAT_EDGES:
+        if (p == end || *p == '#' || *p == '%')
+            return 1;
+        if (!parse_label(&p, end, &src) || p == end)
+            return 0;
+        if (*p == '-')
+            ++p;
+        else if (*p != ' ' && *p != '\t')
+            return 0;
+        p = skip_blanks(p, end);
+        if (!parse_label(&p, end, &trgt))
+            return 0;
+        if (skip_blanks(p, end) != end)
+            return 0;
+        edge_list_push(list, src, trgt);
+        return 1;
+
+    case FORMAT_DIMACS:
+        if (p == end || *p == 'c' || *p == 'p')
+            return 1;
+        if (*p != 'a')
+            return 0;
+        p = skip_blanks(p + 1, end);
+        if (!parse_label(&p, end, &src))
+            return 0;
+        p = skip_blanks(p, end);
+        if (!parse_label(&p, end, &trgt))
+            return 0;
+        edge_list_push(list, src, trgt);
+        return 1;
+
+    case FORMAT_METIS:
+        if (p < end && *p == '%')
+            return 1;
+        if (!parser->metis_header)
+        {
+            if (p == end)
+                return 1;
+            if (!parse_label(&p, end, &parser->metis_n))
+                return 0;
+            p = skip_blanks(p, end);
+            if (!parse_label(&p, end, &value))
+                return 0;
+            p = skip_blanks(p, end);
+            if (parse_label(&p, end, &parser->metis_fmt))
+            {
+                p = skip_blanks(p, end);
+                if (!parse_label(&p, end, &parser->metis_ncon))
+                    parser->metis_ncon = 1;
+            }
+            parser->metis_header = true;
+            return 1;
+        }
+        if (++parser->vertex > parser->metis_n)
+            return p == end;
+
+        /**
+         * skip the vertex size and the vertex weights if fmt announces them
+         */
+        if (parser->metis_fmt / 100 % 10 && !parse_label(&p, end, &value))
+            return 0;
+        for (i = 0; parser->metis_fmt / 10 % 10 && i < parser->metis_ncon; i++)
+        {
+            p = skip_blanks(p, end);
+            if (!parse_label(&p, end, &value))
+                return 0;
+        }
+
+        for (p = skip_blanks(p, end); p != end; p = skip_blanks(p, end))
+        {
+            if (!parse_label(&p, end, &trgt))
+                return 0;
+            edge_list_push(list, parser->vertex, trgt);
+
+            if (parser->metis_fmt % 10)
+            {
+                p = skip_blanks(p, end);
+                if (!parse_label(&p, end, &value))
+                    return 0;
+            }
+        }
+        return 1;
+
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Input parser initialization function.
+ * @brief This function initializes an Input_parser for a given format.
+ * @param parser Pointer to an Input_parser struct.
+ * @param fmt Format of the input.
+ * @return none
+ */
+static void parser_init(Input_parser *parser, Graph_format fmt)
+{
+    memset(parser, 0, sizeof(Input_parser));
+    parser->fmt = fmt;
+}
+
+/**
+ * Input error function.
+ * @brief This function reports a malformed input line and terminates the program.
+ * @param fmt Format of the input.
+ * @param line_no Number of the malformed line, starting at 1.
+ * @return none
+ */
+static void input_error(Graph_format fmt, size_t line_no)
+{
+    fprintf(stderr, "ERROR: Malformed %s input in line %zu!\n", format_name(fmt), line_no);
+    exit(EXIT_FAILURE);
+}
+
+int edge_from_arg(const char *arg, Label *src, Label *trgt)
+{
+    const char *end = arg + strlen(arg);
+
+    if (!parse_label(&arg, end, src) || arg == end || *arg++ != '-')
+        return 0;
+    if (!parse_label(&arg, end, trgt))
+        return 0;
+    return arg == end;
+}
+
+void load_edges(FILE *in, Graph_format fmt, Edge_list *list, Input_stats *stats)
+{
+    char *line = NULL;
+    size_t len = 0;
+    size_t line_no = 0;
+    ssize_t read;
+    Input_parser parser;
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    parser_init(&parser, fmt);
+
+    if (stats != NULL)
+    {
+        stats->bytes = 0;
+        stats->threads = 1;
+    }
+
+    while ((read = getline(&line, &len, in)) != -1)
+    {
+        ++line_no;
+        if (stats != NULL)
+            stats->bytes += read;
+        if (read > 0 && line[read - 1] == '\n')
+            --read;
+        if (!parse_line(&parser, line, line + read, list))
+            input_error(parser.fmt, line_no);
+    }
+
+    if (ferror(in))
+    {
+        fprintf(stderr, "ERROR: Reading the graph input failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    free(line);
+
+    if (stats != NULL)
+        stats->ms = elapsed_ms(&start);
+}
+
+/**
+ * Parse chunk function.
+ * @brief This function parses a chunk of a mapped input as a parser thread.
+ * @details The lines are split with memchr(3), which scans for the newlines with
+ * vectorized instructions. Parsing stops at the first malformed line, whose position
+ * is stored in the chunk.
+ * @param arg Void pointer to the Parse_chunk struct to be parsed.
+ * @return Returns NULL.
+ */
+static void *parse_chunk(void *arg)
+{
+    Parse_chunk *chunk = arg;
+    Input_parser parser;
+    const char *p, *nl;
+
+    parser_init(&parser, chunk->fmt);
+
+    for (p = chunk->begin; p < chunk->end; p = nl + 1)
+    {
+        nl = memchr(p, '\n', chunk->end - p);
+        if (nl == NULL)
+            nl = chunk->end;
+        if (!parse_line(&parser, p, nl, &chunk->list))
+        {
+            chunk->error = p;
+            break;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @details Line based formats are split into chunks at newline boundaries, one per
+ * parser thread, and the edges of the chunks are concatenated in input order. METIS
+ * lists are parsed in a single chunk since the vertex of a line is its line number.
+ * The line number of a malformed line is only counted when reporting the error.
+ */
+void load_edges_file(const char *path, Graph_format fmt, Edge_list *list, Input_stats *stats)
+{
+    int fd, i, threads;
+    struct stat st;
+    struct timespec start;
+    const char *data, *p, *nl, *error;
+    size_t size, line_no;
+    long cpus;
+    Parse_chunk chunks[PARSE_MAX_THREADS];
+    pthread_t tids[PARSE_MAX_THREADS];
+    FILE *in;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    fd = open(path, O_RDONLY);
+    if (fd == -1)
+    {
+        fprintf(stderr, "ERROR: Graph file %s cannot be opened!\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    /**
+     * pipes and other special files cannot be mapped, read them as a stream instead
+     */
+    if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode) || st.st_size == 0)
+    {
+        in = fdopen(fd, "r");
+        assert(in);
+        load_edges(in, fmt, list, stats);
+        fclose(in);
+        return;
+    }
+
+    size = st.st_size;
+    data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+    {
+        fprintf(stderr, "ERROR: Failed mapping graph file %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+    madvise((void *)data, size, MADV_SEQUENTIAL);
+
+    /**
+     * the format must be known before splitting, every chunk is parsed with the same one
+     */
+    for (p = data; fmt == FORMAT_AUTO && p < data + size; p = nl + 1)
+    {
+        nl = memchr(p, '\n', data + size - p);
+        if (nl == NULL)
+            nl = data + size;
+        fmt = line_format(skip_blanks(p, nl), nl);
+    }
+    if (fmt == FORMAT_AUTO)
+        fmt = FORMAT_EDGES;
+
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = size / PARSE_MIN_CHUNK + 1;
+    if (threads > cpus)
+        threads = cpus;
+    if (threads > PARSE_MAX_THREADS)
+        threads = PARSE_MAX_THREADS;
+    if (threads < 1 || fmt == FORMAT_METIS)
+        threads = 1;
+
+    for (i = 0, p = data; i < threads; i++)
+    {
+        chunks[i].fmt = fmt;
+        chunks[i].begin = p;
+        chunks[i].error = NULL;
+        edge_list_init(&chunks[i].list);
+
+        if (i == threads - 1)
+            p = data + size;
+        else
+        {
+            /**
+             * move the even split point forward to just after the next newline
+             */
+            p = data + size / threads * (i + 1);
+            if (p < chunks[i].begin)
+                p = chunks[i].begin;
+            nl = memchr(p, '\n', data + size - p);
+            p = (nl == NULL) ? data + size : nl + 1;
+        }
+        chunks[i].end = p;
+    }
+
+    for (i = 1; i < threads; i++)
+    {
+        if (pthread_create(&tids[i], NULL, parse_chunk, &chunks[i]) != 0)
+        {
+            fprintf(stderr, "ERROR: Parser thread creation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    parse_chunk(&chunks[0]);
+    for (i = 1; i < threads; i++)
+        pthread_join(tids[i], NULL);
+
+    error = NULL;
+    for (i = 0; i < threads && error == NULL; i++)
+        error = chunks[i].error;
+
+    if (error != NULL)
+    {
+        for (p = data, line_no = 1; (nl = memchr(p, '\n', error - p)) != NULL; p = nl + 1)
+            ++line_no;
+        input_error(fmt, line_no);
+    }
+
+    for (i = 0; i < threads; i++)
+    {
+        if (list->num_e + chunks[i].list.num_e > list->cap)
+        {
+            list->cap = list->num_e + chunks[i].list.num_e;
+            list->edges = realloc(list->edges, sizeof(Label_edge) * list->cap);
+            assert(list->edges);
+        }
+        memcpy(list->edges + list->num_e, chunks[i].list.edges, sizeof(Label_edge) * chunks[i].list.num_e);
+        list->num_e += chunks[i].list.num_e;
+        edge_list_free(&chunks[i].list);
+    }
+
+    munmap((void *)data, size);
+
+    if (stats != NULL)
+    {
+        stats->bytes = size;
+        stats->threads = threads;
+        stats->ms = elapsed_ms(&start);
+    }
+}
+
+/**
+ * @details Every edge contributes its source and target label, duplicates are only
+ * dropped when the labels are mapped to their dense vertex indices.
+ */
+Graph_ptr graph_load(const Edge_list *list, Label_map **map)
+{
+    Graph_ptr g;
+    Label *endpoints;
+    int *endpoint_idx;
+    size_t i;
+
+    endpoints = malloc(sizeof(Label) * 2 * (list->num_e > 0 ? list->num_e : 1));
+    endpoint_idx = malloc(sizeof(int) * 2 * (list->num_e > 0 ? list->num_e : 1));
+    assert(endpoints && endpoint_idx);
+
+    for (i = 0; i < list->num_e; i++)
+    {
+        endpoints[2 * i] = list->edges[i].src;
+        endpoints[2 * i + 1] = list->edges[i].trgt;
+    }
+
+    *map = label_map_create(endpoints, 2 * list->num_e, endpoint_idx);
+    free(endpoints);
+
+    g = graph_create(label_map_size(*map));
+    for (i = 0; i < list->num_e; i++)
+        graph_add_edge(g, endpoint_idx[2 * i], endpoint_idx[2 * i + 1]);
+    free(endpoint_idx);
+
+    graph_finalize(g);
+
+    return g;
+}
+
+/**
+ * Fingerprint mix function.
+ * @brief This function mixes a value into a running 64 bit fingerprint.
+ * @param h The running fingerprint.
+ * @param value The value to be mixed in.
+ * @return Returns the updated fingerprint.
+ */
+static uint64_t fingerprint_mix(uint64_t h, uint64_t value)
+{
+    h ^= value;
+    h *= 0x100000001b3ULL;
+    return h ^ (h >> 29);
+}
+
+uint64_t graph_fingerprint(Graph_ptr g, Label_map *map)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    int i;
+
+    assert(g->is_final);
+    assert(map->n == g->V);
+
+    h = fingerprint_mix(h, g->V);
+    h = fingerprint_mix(h, g->E);
+    for (i = 0; i < g->V; i++)
+        h = fingerprint_mix(h, map->labels[i]);
+    for (i = 0; i <= g->V; i++)
+        h = fingerprint_mix(h, g->offsets[i]);
+    for (i = 0; i < g->E; i++)
+        h = fingerprint_mix(h, g->targets[i]);
+    return h;
+}
+
+/**
+ * Binary graph header function.
+ * @brief This function fills in the Fasg_header of a finalized Graph_ptr.
+ * @param header Pointer to the Fasg_header struct to be filled in.
+ * @param g Pointer to a finalized Graph_ptr struct.
+ * @param map Pointer to the Label_map of the graph.
+ * @return none
+ */
+static void fasg_header_init(Fasg_header *header, Graph_ptr g, Label_map *map)
+{
+    assert(g->is_final);
+    assert(map->n == g->V);
+
+    memset(header, 0, sizeof(Fasg_header));
+    memcpy(header->magic, FASG_MAGIC, sizeof(header->magic));
+    header->version = FASG_VERSION;
+    header->V = g->V;
+    header->E = g->E;
+    header->fingerprint = graph_fingerprint(g, map);
+    header->max_out = g->max_out;
+    header->max_in = g->max_in;
+    header->labels_at = sizeof(Fasg_header);
+    header->offsets_at = header->labels_at + sizeof(Label) * header->V;
+    header->targets_at = header->offsets_at + sizeof(int32_t) * (header->V + 1);
+    header->size = header->targets_at + sizeof(int32_t) * header->E;
+}
+
+size_t graph_fasg_size(Graph_ptr g)
+{
+    return sizeof(Fasg_header) + sizeof(Label) * g->V + sizeof(int32_t) * (g->V + 1) + sizeof(int32_t) * g->E;
+}
+
+uint64_t graph_store_fasg(Graph_ptr g, Label_map *map, void *dst)
+{
+    Fasg_header header;
+    char *data = dst;
+
+    fasg_header_init(&header, g, map);
+
+    memcpy(data, &header, sizeof(Fasg_header));
+    memcpy(data + header.labels_at, map->labels, sizeof(Label) * g->V);
+    memcpy(data + header.offsets_at, g->offsets, sizeof(int32_t) * (g->V + 1));
+    memcpy(data + header.targets_at, g->targets, sizeof(int32_t) * g->E);
+
+    return header.fingerprint;
+}
+
+void graph_write_fasg(Graph_ptr g, Label_map *map, const char *path)
+{
+    Fasg_header header;
+    FILE *out;
+
+    fasg_header_init(&header, g, map);
+
+    out = strcmp(path, "-") == 0 ? stdout : fopen(path, "wb");
+    if (out == NULL)
+    {
+        fprintf(stderr, "ERROR: Graph file %s cannot be created!\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    if (fwrite(&header, sizeof(Fasg_header), 1, out) != 1 ||
+        fwrite(map->labels, sizeof(Label), g->V, out) != (size_t)g->V ||
+        fwrite(g->offsets, sizeof(int32_t), g->V + 1, out) != (size_t)g->V + 1 ||
+        fwrite(g->targets, sizeof(int32_t), g->E, out) != (size_t)g->E ||
+        fflush(out) != 0)
+    {
+        fprintf(stderr, "ERROR: Writing graph file %s failed!\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    if (out != stdout)
+        fclose(out);
+}
+
+/**
+ * Map binary graph function.
+ * @brief This function maps an opened binary graph image as a finalized Graph_ptr.
+ * @details The image is mapped shared and read-only, so that all processes mapping the
+ * same file or shared memory object share one copy of it. Only the header is validated,
+ * the rows are used as they are. The file descriptor is closed.
+ * @param fd File descriptor of the binary graph file or shared memory object.
+ * @param name Name of the file or shared memory object for error messages.
+ * @param map Pointer to the Label_map pointer receiving the Label_map of the graph.
+ * @return Returns a pointer to a finalized Graph_ptr struct.
+ */
+/**
+ * The rows of a mapped graph must be exactly those graph_finalize() produces: the row
+ * offsets run from 0 to E without decreasing, and the targets of every row are vertices
+ * in strictly ascending order. Anything else would let the graph functions read and
+ * write out of bounds.
+ */
+static bool fasg_rows_valid(const int *offsets, const int *targets, int V, int E)
+{
+    if (offsets[0] != 0 || offsets[V] != E)
+        return false;
+
+    for (int u = 0; u < V; u++)
+    {
+        if (offsets[u + 1] < offsets[u] || offsets[u + 1] > E)
+            return false;
+
+        for (int i = offsets[u]; i < offsets[u + 1]; i++)
+        {
+            if (targets[i] < 0 || targets[i] >= V || (i > offsets[u] && targets[i] <= targets[i - 1]))
+                return false;
+        }
+    }
+    return true;
+}
+
+static Graph_ptr graph_map_fd(int fd, const char *name, Label_map **map)
+{
+    struct stat st;
+    char *data;
+    Fasg_header header;
+    Graph_ptr g;
+
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(Fasg_header))
+    {
+        fprintf(stderr, "ERROR: Graph %s is truncated!\n", name);
+        exit(EXIT_FAILURE);
+    }
+
+    data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED)
+    {
+        fprintf(stderr, "ERROR: Failed mapping graph %s\n", name);
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+
+    memcpy(&header, data, sizeof(Fasg_header));
+    if (memcmp(header.magic, FASG_MAGIC, sizeof(header.magic)) != 0 || header.version != FASG_VERSION)
+    {
+        fprintf(stderr, "ERROR: Graph %s has an unknown format or version!\n", name);
+        exit(EXIT_FAILURE);
+    }
+
+    /**
+     * graph_write_fasg() always writes the same layout, which is required exactly, so no
+     * offset taken from the file is used in any arithmetic before it has been checked.
+     */
+    if (header.V >= INT32_MAX || header.E > INT32_MAX ||
+        header.labels_at != sizeof(Fasg_header) ||
+        header.offsets_at != header.labels_at + sizeof(Label) * header.V ||
+        header.targets_at != header.offsets_at + sizeof(int32_t) * (header.V + 1) ||
+        header.size != header.targets_at + sizeof(int32_t) * header.E ||
+        header.size != (uint64_t)st.st_size ||
+        !fasg_rows_valid((const int *)(data + header.offsets_at), (const int *)(data + header.targets_at),
+                         (int)header.V, (int)header.E))
+    {
+        fprintf(stderr, "ERROR: Graph %s is corrupted!\n", name);
+        exit(EXIT_FAILURE);
+    }
+
+    g = graph_create(header.V);
+    free(g->staged);
+    g->staged = NULL;
+    g->cap = 0;
+
+    g->E = header.E;
+    g->offsets = (int *)(data + header.offsets_at);
+    g->targets = (int *)(data + header.targets_at);
+    g->max_out = header.max_out;
+    g->max_in = header.max_in;
+    g->mapping = data;
+    g->map_size = st.st_size;
+    g->is_final = true;
+
+    *map = malloc(sizeof(Label_map));
+    assert(*map);
+    (*map)->n = header.V;
+    (*map)->is_mapped = true;
+    (*map)->labels = (Label *)(data + header.labels_at);
+
+    return g;
+}
+
+Graph_ptr graph_map_fasg(const char *path, Label_map **map)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+    {
+        fprintf(stderr, "ERROR: Graph file %s cannot be opened!\n", path);
+        exit(EXIT_FAILURE);
+    }
+    return graph_map_fd(fd, path, map);
+}
+
+Graph_ptr graph_attach_shm(const char *shm_name, Label_map **map)
+{
+    int fd = shm_open(shm_name, O_RDONLY, 0);
+    if (fd == -1)
+    {
+        fprintf(stderr, "ERROR: Shared graph %s cannot be opened!\n", shm_name);
+        exit(EXIT_FAILURE);
+    }
+    return graph_map_fd(fd, shm_name, map);
+}
+
+/**
+ * @details A binary graph file is recognized by its magic bytes if the format is
+ * FORMAT_AUTO. Text inputs are loaded with load_edges() for stdin and with
+ * load_edges_file() otherwise, after which the graph is built with graph_load().
+ */
+Graph_ptr graph_read(const char *path, Graph_format fmt, Label_map **map, Input_stats *stats)
+{
+    Graph_ptr g;
+    Edge_list list;
+    struct timespec start;
+    char magic[sizeof(FASG_MAGIC) - 1];
+    FILE *in;
+
+    if (fmt == FORMAT_AUTO && strcmp(path, "-") != 0 && (in = fopen(path, "rb")) != NULL)
+    {
+        if (fread(magic, sizeof(magic), 1, in) == 1 && memcmp(magic, FASG_MAGIC, sizeof(magic)) == 0)
+            fmt = FORMAT_FASG;
+        fclose(in);
+    }
+
+    if (fmt == FORMAT_FASG)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        g = graph_map_fasg(path, map);
+        if (stats != NULL)
+        {
+            stats->bytes = g->map_size;
+            stats->threads = 1;
+            stats->ms = elapsed_ms(&start);
+        }
+        return g;
+    }
+
+    edge_list_init(&list);
+    if (strcmp(path, "-") == 0)
+        load_edges(stdin, fmt, &list, stats);
+    else
+        load_edges_file(path, fmt, &list, stats);
+
+    if (list.num_e == 0)
+    {
+        fprintf(stderr, "ERROR: The graph in %s has no edges!\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    g = graph_load(&list, map);
+    edge_list_free(&list);
+
+    return g;
+}
+
+/** 
+ * ---------------------------------------------------------------------------------
+ *                              Label_map functions implementations
+ * ---------------------------------------------------------------------------------
+ */
+
+/**
+ * @details Every label is sorted along with its position in the passed array, hence
+ * after the last pass the dense index of a run of equal labels can be written back to
+ * all the positions the label was taken from.
+ */
+Label_map *label_map_create(const Label *labels, size_t size, int *index)
+{
+    Label_map *map;
+    Label *keys, *keys_tmp, *swap_keys;
+    size_t *pos, *pos_tmp, *swap_pos;
+    size_t i, at, count[8][256];
+    int b, n;
+
+    map = malloc(sizeof(Label_map));
+    keys = malloc(sizeof(Label) * (size > 0 ? size : 1));
+    keys_tmp = malloc(sizeof(Label) * (size > 0 ? size : 1));
+    pos = malloc(sizeof(size_t) * (size > 0 ? size : 1));
+    pos_tmp = malloc(sizeof(size_t) * (size > 0 ? size : 1));
+    assert(map && keys && keys_tmp && pos && pos_tmp);
+
+    /**
+     * the histograms of all eight bytes are counted in a single pass over the labels
+     */
+    memset(count, 0, sizeof(count));
+    for (i = 0; i < size; i++)
+    {
+        keys[i] = labels[i];
+        pos[i] = i;
+        for (b = 0; b < 8; b++)
+            count[b][(keys[i] >> (8 * b)) & 0xff]++;
+    }
+
+    for (b = 0; b < 8; b++)
+    {
+        /**
+         * all labels share this byte, the pass wouldn't change the order
+         */
+        if (size == 0 || count[b][(keys[0] >> (8 * b)) & 0xff] == size)
+            continue;
+
+        for (i = 0, at = 0; i < 256; i++)
+        {
+            size_t c = count[b][i];
+            count[b][i] = at;
+            at += c;
+        }
+
+        for (i = 0; i < size; i++)
+        {
+            at = count[b][(keys[i] >> (8 * b)) & 0xff]++;
+            keys_tmp[at] = keys[i];
+            pos_tmp[at] = pos[i];
+        }
+
+        swap_keys = keys, keys = keys_tmp, keys_tmp = swap_keys;
+        swap_pos = pos, pos = pos_tmp, pos_tmp = swap_pos;
+    }
+
+    for (i = 0, n = 0; i < size; i++)
+    {
+        if (n == 0 || keys[n - 1] != keys[i])
+            keys[n++] = keys[i];
+        if (index != NULL)
+            index[pos[i]] = n - 1;
+    }
+
+    free(keys_tmp);
+    free(pos);
+    free(pos_tmp);
+
+    map->n = n;
+    map->is_mapped = false;
+    map->labels = realloc(keys, sizeof(Label) * (n > 0 ? n : 1));
+    assert(map->labels);
+
+    return map;
+}
+
+void label_map_destroy(Label_map *map)
+{
+    if (!map->is_mapped)
+        free(map->labels);
+    free(map);
+}
+
+int label_map_size(Label_map *map)
+{
+    return map->n;
+}
+
+int label_map_index(Label_map *map, Label label)
+{
+    Label *found = bsearch(&label, map->labels, map->n, sizeof(Label), cmp_label);
+
+    if (found == NULL)
+        return -1;
+    return found - map->labels;
+}
+
+Label label_map_label(Label_map *map, int index)
+{
+    assert(index >= 0);
+    assert(index < map->n);
+
+    return map->labels[index];
+}
+
+/**
+ * ---------------------------------------------------------------------------------
+ *                         Ring buffer functions implementations
+ * ---------------------------------------------------------------------------------
+ */
+
+/**
+ * A channel is padded to whole cache lines, so that the channels don't share any line.
+ */
+static size_t channel_size(int slots)
+{
+    size_t size = sizeof(Channel) + sizeof(Fb_arc_set) * slots;
+    return (size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+}
+
+size_t ring_size(int channels, int slots, int best_e, int best_v)
+{
+    return sizeof(Buffer) + channel_size(slots) * channels + sizeof(Label_edge) * best_e + sizeof(Label) * best_v;
+}
+
+Channel *ring_channel(Buffer *buf, int index)
+{
+    return (Channel *)((char *)buf + sizeof(Buffer) + channel_size(buf->header.slots) * index);
+}
+
+/**
+ * The start time of a process in clock ticks since boot, read from /proc/<pid>/stat,
+ * tells it apart from a later process with the same process id. A process which doesn't
+ * exist anymore or is a zombie, which kill(2) still reaches, has the start time 0.
+ */
+static uint64_t process_start(int pid)
+{
+    char path[32], line[512];
+    char state = 'X';
+    uint64_t start = 0;
+
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+        return 0;
+    char *comm_end = fgets(line, sizeof(line), file) != NULL ? strrchr(line, ')') : NULL;
+    fclose(file);
+
+    /**
+     * The command name may contain blanks and parentheses, the fields are counted from
+     * its closing parenthesis on: the state is the third field, the start time the 22nd.
+     */
+    if (comm_end == NULL ||
+        sscanf(comm_end + 1, " %c %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %" SCNu64,
+               &state, &start) != 2 ||
+        state == 'Z' || state == 'X' || state == 'x')
+        return 0;
+    return start;
+}
+
+/**
+ * The edges of the best register follow the channels, its ordering follows the edges.
+ */
+static Label_edge *best_edges(Buffer *buf)
+{
+    return (Label_edge *)ring_channel(buf, buf->header.channels);
+}
+
+static Label *best_order(Buffer *buf)
+{
+    return (Label *)(best_edges(buf) + buf->header.best_e);
+}
+
+void ring_reserve(Buffer *buf)
+{
+    buf->header.version = RING_VERSION;
+    __atomic_store_n(&buf->header.owner, (uint32_t)getpid(), __ATOMIC_RELEASE);
+}
+
+void ring_init(Buffer *buf, int channels, int slots, int best_e, int best_v, uint64_t seed)
+{
+    buf->header.version = RING_VERSION;
+    buf->header.channels = channels;
+    buf->header.slots = slots;
+    buf->header.slot_size = sizeof(Fb_arc_set);
+    buf->header.best_e = best_e;
+    buf->header.best_v = best_v;
+    buf->header.owner = (uint32_t)getpid();
+    buf->header.size = ring_size(channels, slots, best_e, best_v);
+
+    for (int i = 0; i < channels; i++)
+    {
+        Channel *ch = ring_channel(buf, i);
+        ch->owner = 0;
+        ch->head = 0;
+        ch->tail = 0;
+    }
+
+    buf->best.seq = 0;
+    buf->best.num_e = INT_MAX;
+    buf->best.stored_e = 0;
+    buf->best.stored_v = 0;
+    buf->bound = INT_MAX;
+    buf->wake = 0;
+    buf->parked = 0;
+    buf->seed = seed;
+    buf->streams = 0;
+
+    __atomic_store_n(&buf->header.magic, RING_MAGIC, __ATOMIC_RELEASE);
+}
+
+Buffer *ring_attach(char *shm_name, int *shm_fd)
+{
+    struct stat sb;
+    *shm_fd = attach_shm(shm_name, sizeof(Buffer));
+
+    Buffer *buf = open_shm(*shm_fd, sizeof(Buffer));
+    Ring_header header = buf->header;
+    header.magic = __atomic_load_n(&buf->header.magic, __ATOMIC_ACQUIRE);
+    unmap_shm(buf, sizeof(Buffer));
+
+    if (header.magic != RING_MAGIC)
+    {
+        fprintf(stderr, "ERROR: The supervisor hasn't set up the ring buffer yet!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (header.version != RING_VERSION || header.slot_size != sizeof(Fb_arc_set) ||
+        header.slots < RING_MIN_SLOTS || header.slots > RING_MAX_SLOTS ||
+        header.channels < 1 || header.channels > MAX_CHANNELS ||
+        header.size != ring_size(header.channels, header.slots, header.best_e, header.best_v) ||
+        fstat(*shm_fd, &sb) == -1 || (uint64_t)sb.st_size < header.size)
+    {
+        fprintf(stderr, "ERROR: The ring buffer layout doesn't match, version %" PRIu32 " with %" PRIu32
+                        " channels of %" PRIu32 " slots of %" PRIu32 " bytes!\n",
+                header.version, header.channels, header.slots, header.slot_size);
+        exit(EXIT_FAILURE);
+    }
+
+    return open_shm(*shm_fd, header.size);
+}
+
+bool ring_stale(char *shm_name)
+{
+    struct stat sb;
+    int shm_fd = shm_open(shm_name, O_RDONLY, 0);
+    if (shm_fd == -1)
+        return false;
+
+    if (fstat(shm_fd, &sb) == -1 || (size_t)sb.st_size < sizeof(Ring_header))
+    {
+        close(shm_fd);
+        return true;
+    }
+
+    Ring_header *header = mmap(NULL, sizeof(Ring_header), PROT_READ, MAP_SHARED, shm_fd, 0);
+    close(shm_fd);
+    if (header == MAP_FAILED)
+    {
+        fprintf(stderr, "ERROR: Mapping of the shared memory failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /**
+     * The owner is recorded before the supervisor publishes the graph, which may take a
+     * while, hence a ring buffer without the magic yet belongs to a live supervisor
+     * unless its owner is unknown or gone.
+     */
+    uint32_t owner = __atomic_load_n(&header->owner, __ATOMIC_ACQUIRE);
+    bool stale = __atomic_load_n(&header->version, __ATOMIC_RELAXED) != RING_VERSION || owner == 0 ||
+                 process_start((int)owner) == 0;
+    munmap(header, sizeof(Ring_header));
+    return stale;
+}
+
+Channel *channel_register(Buffer *buf, int writer)
+{
+    for (uint32_t i = 0; i < buf->header.channels; i++)
+    {
+        Channel *ch = ring_channel(buf, i);
+        int owner = 0;
+
+        if (__atomic_load_n(&ch->owner, __ATOMIC_RELAXED) == 0 &&
+            __atomic_compare_exchange_n(&ch->owner, &owner, writer, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            __atomic_store_n(&ch->started, process_start(writer), __ATOMIC_RELEASE);
+            return ch;
+        }
+    }
+    return NULL;
+}
+
+void channel_release(Channel *ch)
+{
+    __atomic_store_n(&ch->started, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&ch->owner, 0, __ATOMIC_RELEASE);
+}
+
+uint64_t ring_stream(Buffer *buf)
+{
+    return __atomic_fetch_add(&buf->streams, 1, __ATOMIC_RELAXED);
+}
+
+int channel_orphaned(Channel *ch)
+{
+    int owner = __atomic_load_n(&ch->owner, __ATOMIC_ACQUIRE);
+    if (owner == 0)
+        return 0;
+
+    /**
+     * The start time is 0 until the owner has recorded it, the owner is then only
+     * checked for being alive.
+     */
+    uint64_t start = process_start(owner);
+    uint64_t started = __atomic_load_n(&ch->started, __ATOMIC_ACQUIRE);
+    if (start != 0 && (started == 0 || started == start))
+        return 0;
+    return owner;
+}
+
+void channel_reclaim(Channel *ch, int owner)
+{
+    if (__atomic_compare_exchange_n(&ch->owner, &owner, 0, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        __atomic_store_n(&ch->started, 0, __ATOMIC_RELAXED);
+}
+
+Fb_arc_set *channel_claim(Buffer *buf, Channel *ch)
+{
+    uint64_t pos = __atomic_load_n(&ch->head, __ATOMIC_RELAXED);
+
+    if (pos - __atomic_load_n(&ch->tail, __ATOMIC_ACQUIRE) >= buf->header.slots)
+        return NULL;
+    return &ch->sets[pos % buf->header.slots];
+}
+
+void channel_commit(Channel *ch)
+{
+    __atomic_store_n(&ch->head, __atomic_load_n(&ch->head, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+const Fb_arc_set *channel_peek(Buffer *buf, Channel *ch)
+{
+    uint64_t pos = __atomic_load_n(&ch->tail, __ATOMIC_RELAXED);
+
+    if (__atomic_load_n(&ch->head, __ATOMIC_ACQUIRE) == pos)
+        return NULL;
+    return &ch->sets[pos % buf->header.slots];
+}
+
+void channel_consume(Channel *ch)
+{
+    __atomic_store_n(&ch->tail, __atomic_load_n(&ch->tail, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+int best_size(Buffer *buf)
+{
+    return __atomic_load_n(&buf->best.num_e, __ATOMIC_RELAXED);
+}
+
+int best_bound(Buffer *buf)
+{
+    return __atomic_load_n(&buf->bound, __ATOMIC_RELAXED);
+}
+
+void best_lower_bound(Buffer *buf, int num_e)
+{
+    int bound = __atomic_load_n(&buf->bound, __ATOMIC_RELAXED);
+
+    while (num_e < bound &&
+           !__atomic_compare_exchange_n(&buf->bound, &bound, num_e, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+void best_publish(Buffer *buf, const Label_edge edges[], int num_e, const Label order[], int num_v)
+{
+    uint64_t seq = buf->best.seq;
+    int stored_e = num_e < (int)buf->header.best_e ? num_e : (int)buf->header.best_e;
+    int stored_v = num_v <= (int)buf->header.best_v ? num_v : 0;
+
+    __atomic_store_n(&buf->best.seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    memcpy(best_edges(buf), edges, sizeof(Label_edge) * stored_e);
+    memcpy(best_order(buf), order, sizeof(Label) * stored_v);
+    buf->best.stored_e = stored_e;
+    buf->best.stored_v = stored_v;
+    __atomic_store_n(&buf->best.num_e, num_e, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&buf->best.seq, seq + 2, __ATOMIC_RELEASE);
+    best_lower_bound(buf, num_e);
+}
+
+void best_read(Buffer *buf, Label_edge edges[], Label order[], Best_register *reg)
+{
+    uint64_t before, after;
+
+    do
+    {
+        while ((before = __atomic_load_n(&buf->best.seq, __ATOMIC_ACQUIRE)) & 1)
+            sched_yield();
+
+        reg->num_e = __atomic_load_n(&buf->best.num_e, __ATOMIC_RELAXED);
+        /**
+         * The sizes may be torn by a concurrent write, they are only trusted within the
+         * capacities until the sequence number confirms them.
+         */
+        reg->stored_e = buf->best.stored_e;
+        reg->stored_v = buf->best.stored_v;
+        if (reg->stored_e < 0 || reg->stored_e > (int)buf->header.best_e)
+            reg->stored_e = 0;
+        if (reg->stored_v < 0 || reg->stored_v > (int)buf->header.best_v)
+            reg->stored_v = 0;
+        memcpy(edges, best_edges(buf), sizeof(Label_edge) * reg->stored_e);
+        memcpy(order, best_order(buf), sizeof(Label) * reg->stored_v);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&buf->best.seq, __ATOMIC_RELAXED);
+    } while (before != after);
+
+    reg->seq = after;
+}
+
+/**
+ * The futex word lives in the shared memory, which is mapped by unrelated processes,
+ * hence the shared (non private) futex operations.
+ */
+static long futex(uint32_t *word, int op, uint32_t val, const struct timespec *timeout)
+{
+    return syscall(SYS_futex, word, op, val, timeout, NULL, 0);
+}
+
+/**
+ * Whether any channel holds a part which the supervisor hasn't read yet.
+ */
+static bool ring_pending(Buffer *buf)
+{
+    for (uint32_t i = 0; i < buf->header.channels; i++)
+    {
+        Channel *ch = ring_channel(buf, i);
+        if (__atomic_load_n(&ch->head, __ATOMIC_ACQUIRE) != ch->tail)
+            return true;
+    }
+    return false;
+}
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+void ring_backoff_init(Ring_backoff *b)
+{
+    b->polls = 0;
+    b->idle_since = 0;
+    b->idle_avg = RING_SPIN_MAX_NS;
+    b->window = RING_SPIN_MIN_NS;
+}
+
+void ring_arrival(Ring_backoff *b)
+{
+    if (b->polls == 0)
+        return;
+
+    uint64_t idle = monotonic_ns() - b->idle_since;
+    b->idle_avg = b->idle_avg - b->idle_avg / RING_IDLE_WEIGHT + idle / RING_IDLE_WEIGHT;
+
+    if (b->idle_avg > RING_SPIN_MAX_NS)
+        b->window = RING_SPIN_MIN_NS;
+    else if (2 * b->idle_avg > RING_SPIN_MAX_NS)
+        b->window = RING_SPIN_MAX_NS;
+    else if (2 * b->idle_avg < RING_SPIN_MIN_NS)
+        b->window = RING_SPIN_MIN_NS;
+    else
+        b->window = 2 * b->idle_avg;
+
+    b->polls = 0;
+}
+
+void ring_backoff(Buffer *buf, Ring_backoff *b)
+{
+    struct timespec timeout = {RING_PARK_MS / 1000, RING_PARK_MS % 1000 * 1000000L};
+
+    if (b->polls++ == 0)
+        b->idle_since = monotonic_ns();
+    if (b->polls <= RING_SPINS)
+        return;
+    if (monotonic_ns() - b->idle_since < b->window)
+    {
+        sched_yield();
+        return;
+    }
+
+    /**
+     * The flag is raised before the channels are checked a last time, a generator which
+     * writes a part afterwards sees the flag and bumps the futex word, on which the wait
+     * then doesn't block.
+     */
+    uint32_t wake = __atomic_load_n(&buf->wake, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&buf->parked, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    if (!ring_pending(buf) && buf->quit != 1)
+    {
+        if (futex(&buf->wake, FUTEX_WAIT, wake, &timeout) == -1 &&
+            errno != EAGAIN && errno != EINTR && errno != ETIMEDOUT)
+        {
+            fprintf(stderr, "ERROR: Futex wait failed!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    __atomic_store_n(&buf->parked, 0, __ATOMIC_RELAXED);
+}
+
+void ring_notify(Buffer *buf)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&buf->parked, __ATOMIC_RELAXED) == 0 ||
+        __atomic_exchange_n(&buf->parked, 0, __ATOMIC_ACQ_REL) == 0)
+        return;
+
+    __atomic_add_fetch(&buf->wake, 1, __ATOMIC_RELEASE);
+    if (futex(&buf->wake, FUTEX_WAKE, 1, NULL) == -1)
+    {
+        fprintf(stderr, "ERROR: Futex wake failed!\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * ---------------------------------------------------------------------------------
+ *                       Shared memory functions implementations                     
+ * ---------------------------------------------------------------------------------
+ */
+
+int create_shm(char *shm_name)
+{
+    int shm_fd = shm_open(shm_name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (shm_fd == -1 && errno == EEXIST)
+    {
+        fprintf(stderr, "ERROR: Shared memory object %s exists already, it must be removed unless "
+                        "another supervisor is running!\n", shm_name);
+        exit(EXIT_FAILURE);
+    }
+    if (shm_fd == -1)
+    {
+        fprintf(stderr, "ERROR: Shared memory object creation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    return shm_fd;
+}
+
+int attach_shm(char *shm_name, size_t shm_size)
+{
+    struct stat sb;
+    int shm_fd = shm_open(shm_name, O_RDWR, 0);
+    if (shm_fd == -1)
+    {
+        fprintf(stderr, "ERROR: Shared memory object doesn't exist, is the supervisor running?\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (fstat(shm_fd, &sb) == -1 || (size_t)sb.st_size < shm_size)
+    {
+        fprintf(stderr, "ERROR: Shared memory object has not been set up!\n");
         exit(EXIT_FAILURE);
     }
     return shm_fd;
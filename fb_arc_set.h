@@ -15,17 +15,23 @@
 #include <stdlib.h>
 #include <time.h>
 #include <unistd.h>
+#include <getopt.h>
 #include <errno.h>
 #include <string.h>
 #include <signal.h>
 #include <fcntl.h>
-#include <regex.h>
 #include <assert.h>
 #include <stdbool.h>
 #include <stdint.h>
-#include <semaphore.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
 #include "structs.h"
 
@@ -57,80 +63,116 @@ void usage(char *prog);
 int cmpfunc(const void *a, const void *b);
 
 /**
- * Integer value in array function.
- * @brief This function checks if a value is in an array.
- * @details The function doesn't check if the size passed is the actual size
- * of the array, meaning that both indexing out of bounds and not checking all elements
- * are possible scenarios.
- * @param val Value that must be found.
- * @param arr Array of elements to search in.
- * @param size Number of array first array elements to search from.
- * @return Returns 1 if the value is in the array, 0 otherwise.
+ * 2-labels comparison function.
+ * @brief This function compares two Label values.
+ * @details Unlike cmpfunc(), the function doesn't subtract the values, since the
+ * difference of two 64 bit labels doesn't fit into the returned int.
+ * @param a Constant void pointer to first Label.
+ * @param b Constant void pointer to second Label.
+ * @return Returns a negative value, 0 or a positive value if the first Label is
+ * smaller than, equal to or greater than the second one.
  */
-int val_in_arr(int val, int *arr, size_t size);
+int cmp_label(const void *a, const void *b);
 
 /**
- * Source from argument function.
- * @brief This function extracts the source vertex label from an argument.
- * @details The function assumes that the argument passed has a correct formatting.
- * @param arg Argument formatted as <source>-<target> from which to extract the source.
- * return Returns the source vertex label as an int.
+ * Elapsed time function.
+ * @brief This function gives the time passed since a starting point.
+ * @details The function relies on the monotonic clock of clock_gettime(2), the
+ * starting point must have been taken from the same clock.
+ * @param start Pointer to the starting point.
+ * @return Returns the elapsed time in milliseconds.
  */
-int src_from_arg(char *arg);
+double elapsed_ms(const struct timespec *start);
 
 /**
- * Target from argument function.
- * @brief This function extracts the target vertex label from an argument.
- * @details The function assumes that the argument passed has a correct formatting.
- * @param arg Argument formatted as <source>-<target> from which to extract the target.
- * return Returns the target vertex label as an int.
+ * Print solution function.
+ * @brief This function prints a feedback arc set solution.
+ * @details The function takes an array of Label_edge structures and prints each edge
+ * from that array in the format <source>-<target> to stdout, along with the generator
+ * which found the solution.
+ * @param edge_set Label_edge structures array.
+ * @param prog Name of program which calls the print solution function.
+ * @param size Size of the Label_edge structures array.
+ * @param writer Process id of the generator which found the solution.
+ * @return none
+ */
+void print_solution(Label_edge edge_set[], char *prog, int size, int writer);
+
+/**
+ * ---------------------------------------------------------------------------------
+ *                        Random number generator function declarations
+ * ---------------------------------------------------------------------------------
+ * The random numbers are drawn from xoshiro256**, whose state is kept by the caller,
+ * so that threads with a generator of their own don't interfere. Another engine can be
+ * plugged in by replacing the Rng struct together with rng_seed(), rng_next() and
+ * rng_jump(), the bounded numbers and the shuffle only rely on those.
+ */
+
+/**
+ * Stream seed function.
+ * @brief This function derives the seed of a random number stream from a master seed.
+ * @details The master seed and the stream number are mixed by the SplitMix64
+ * finalizer, so that neighbouring streams get unrelated seeds.
+ * @param master The master seed of the run.
+ * @param stream Number of the stream.
+ * @return Returns the seed of the stream.
+ */
+uint64_t stream_seed(uint64_t master, uint64_t stream);
+
+/**
+ * Seed random number generator function.
+ * @brief This function seeds a random number generator.
+ * @details The 256 bit state is filled from the seed by SplitMix64, which never yields
+ * the all zero state.
+ * @param rng Pointer to the Rng struct.
+ * @param seed The seed.
+ * @return none
  */
-int trgt_from_arg(char *arg);
+void rng_seed(Rng *rng, uint64_t seed);
 
 /**
- * Argument edge format function.
- * @brief This function asserts that the passed parameter has a correct formatting.
- * @details The function makes sure that the parameter has a format of the form:
- * <source>-<target> where source and target are integers.
- * @param arg String to be checked for correct formatting.
- * @return Returns 1 if the parameter is formatted correctly, 0 otherwise.
+ * Next random number function.
+ * @brief This function returns the next 64 bit random number of a generator.
+ * @param rng Pointer to the Rng struct.
+ * @return Returns the random number.
  */
-int assert_edge_format(char *arg);
+uint64_t rng_next(Rng *rng);
 
 /**
- * Random number function.
- * @brief This function generates a random number within the lower-upper range.
- * @details The function doesn't check if the passed parameter lower and upper
- * are valid.
- * @param lower Lower range for the possible random numbers.
- * @param upper Upper range for the possible random numbers.
- * @return Returns a random integer number.
+ * Jump random number generator function.
+ * @brief This function advances a random number generator by 2^128 numbers.
+ * @details Jumping a copy of a generator once per thread gives the threads streams
+ * which don't overlap for 2^128 numbers each.
+ * @param rng Pointer to the Rng struct.
+ * @return none
  */
-int generate_random(int lower, int upper);
+void rng_jump(Rng *rng);
+
+/**
+ * Bounded random number function.
+ * @brief This function returns an unbiased random number below the given range.
+ * @details Lemire's method maps a 32 bit random number onto the range by a
+ * multiplication, only the rare draws which would make the result biased are
+ * repeated. No division is needed in the common case.
+ * @param rng Pointer to the Rng struct.
+ * @param range Number of possible results, greater than 0.
+ * @return Returns a random number between 0 and range - 1.
+ */
+uint32_t rng_bounded(Rng *rng, uint32_t range);
 
 /**
  * Shuffle vertex function.
  * @brief This function takes a vertex array and shuffles it randomly.
  * @details The function doesn't check if actual size of the array is the same as the
  * size parameter. That's why only array elements up to index size are shuffled.
- * The shuffling is done using the Monte Carlo randomized algorithm.
+ * The shuffling is done using the Monte Carlo randomized algorithm, the swap
+ * positions being drawn in batches of RNG_BATCH ahead of the swaps.
  * @param set Array of integers to be shuffled.
  * @param size Size of the array to be shuffled.
+ * @param rng Pointer to the Rng struct.
  * @return none
  */
-void shuffle_vertex_set(int *set, size_t size);
-
-/**
- * Print solution function.
- * @brief This function prints a feedback arc set solution.
- * @details The function takes an array of Edge structures and prints each Edge
- * from that array in the format <source>-<target> to stdout.
- * @param edge_set Edge structures array.
- * @param prog Name of program which calls the print solution function.
- * @param size Size of the Edge structures array.
- * @return none
- */
-void print_solution(Edge edge_set[], char *prog, int size);
+void shuffle_vertex_set(int *set, size_t size, Rng *rng);
 
 /** 
  * ---------------------------------------------------------------------------------
@@ -141,8 +183,8 @@ void print_solution(Edge edge_set[], char *prog, int size);
 /**
  * Graph creation function.
  * @brief This function creates a Graph_ptr with n vertices.
- * @details The function allocates enough memory for a Graph_ptr object with n vertices
- * along all other information such as a successors list.
+ * @details The function allocates a Graph_ptr object with n vertices and an empty
+ * array in which the edges are staged until the graph is finalized.
  * @param n Number of vertices in the graph.
  * @return Returns a pointer to a Graph_ptr struct.
  */
@@ -161,8 +203,8 @@ void graph_destroy(Graph_ptr);
  * Add edge function.
  * @brief This function adds a directed edge between two vertices of an existing Graph_ptr.
  * @details The function asserts that it's possible to create an edge between
- * two vertices and adds a directed edge afterwards, updating the respective successors
- * list of the Graph_ptr.
+ * two vertices and that the Graph_ptr hasn't been finalized yet and stages a directed
+ * edge afterwards. The successors lists are only built by graph_finalize().
  * @param Graph_ptr Pointer to a Graph_ptr struct.
  * @param source Source vertex label.
  * @param target Target vertex label.
@@ -170,6 +212,19 @@ void graph_destroy(Graph_ptr);
  */
 void graph_add_edge(Graph_ptr, int source, int target);
 
+/**
+ * Graph finalization function.
+ * @brief This function builds the successor arrays of a Graph_ptr from its added edges.
+ * @details The function must be called once after the last graph_add_edge() call and
+ * before any query of the graph. It sorts every successors list, drops duplicate edges
+ * (which are no longer counted by graph_edge_count()) and records the degree statistics.
+ * Afterwards the graph is read-only: no further edges can be added to it and none of the
+ * query functions allocate memory or reorder the successors lists.
+ * @param Graph_ptr Pointer to a Graph_ptr struct.
+ * @return none
+ */
+void graph_finalize(Graph_ptr);
+
 /**
  * Graph_ptr vertex count function.
  * @brief This function gives the cardinality Graph_ptr.
@@ -186,6 +241,22 @@ int graph_vertex_count(Graph_ptr);
  */
 int graph_edge_count(Graph_ptr);
 
+/**
+ * Maximal out degree function.
+ * @brief This function gives the maximal out degree of a vertex in a finalized Graph_ptr.
+ * @param Graph_ptr Pointer to a Graph_ptr struct.
+ * @return Returns the maximal out degree over all vertices in the graph.
+ */
+int graph_max_out_degree(Graph_ptr);
+
+/**
+ * Maximal in degree function.
+ * @brief This function gives the maximal in degree of a vertex in a finalized Graph_ptr.
+ * @param Graph_ptr Pointer to a Graph_ptr struct.
+ * @return Returns the maximal in degree over all vertices in the graph.
+ */
+int graph_max_in_degree(Graph_ptr);
+
 /**
  * Vertex out degree function.
  * @brief This function gives the out degree of a source vertex in a Graph_ptr.
@@ -200,6 +271,7 @@ int graph_out_degree(Graph_ptr, int source);
  * @brief This function checks if a directed edge between two vertices exists.
  * @details The function assumes that both the source and target vertices actually
  * exist in the graph and checks blindly if there is a directed edge between the two.
+ * The sorted successors list of the source is searched.
  * @param Graph_ptr Pointer to a Graph_ptr struct.
  * @param source Source vertex label.
  * @param target Target vertex label.
@@ -208,72 +280,609 @@ int graph_out_degree(Graph_ptr, int source);
 int graph_has_edge(Graph_ptr, int source, int target);
 
 /**
+ * Vertex successors function.
+ * @brief This function gives the successors list of a source vertex in a Graph_ptr.
+ * @details The returned array holds exactly graph_out_degree() elements in ascending
+ * order and must not be modified or freed by the caller.
+ * @param Graph_ptr Pointer to a Graph_ptr struct.
+ * @param source Source vertex label.
+ * @return Returns a pointer to the first successor of the source vertex.
+ */
+const int *graph_successors(Graph_ptr, int source);
+
+/**
+ * Acyclic ordering function.
+ * @brief This function orders the vertices of the graph without the given edges.
+ * @details The removed edges are looked up in the successor lists and skipped, the
+ * remaining graph is then sorted topologically by repeatedly taking the vertices without
+ * predecessors left. If the removed edges form a feedback arc set, every vertex gets
+ * ordered and none of the remaining edges points backwards in the ordering.
+ * @param Graph_ptr Pointer to a Graph_ptr struct.
+ * @param removed Edge structures array of the edges to be removed.
+ * @param num_removed Size of the removed edges array.
+ * @param order Array of graph_vertex_count() integers receiving the ordering.
+ * @return Returns the number of ordered vertices, less than the vertex count if cycles remain.
+ */
+int graph_acyclic_order(Graph_ptr g, const Edge removed[], int num_removed, int *order);
+
+/**
+ * Strongly connected components function.
+ * @brief This function decomposes a finalized graph into its strongly connected components.
+ * @details The components are found by Tarjan's algorithm, run with an explicit stack
+ * so that long paths don't overflow the call stack. Components of a single vertex
+ * don't lie on a cycle (self-loops never point backwards in an ordering) and are
+ * dropped, the others are numbered in the order Tarjan's algorithm completes them.
+ * @param Graph_ptr Pointer to a finalized Graph_ptr struct.
+ * @return Returns a pointer to the Graph_scc struct, to be freed with graph_scc_destroy().
+ */
+Graph_scc *graph_scc_create(Graph_ptr g);
+
+/**
+ * Strongly connected components destroy function.
+ * @brief This function frees the memory of a Graph_scc struct.
+ * @param scc Pointer to a Graph_scc struct.
+ * @return none
+ */
+void graph_scc_destroy(Graph_scc *scc);
+
+/**
+ * Component feedback arc set function.
+ * @brief This function collects the feedback arc set of a component induced by an ordering.
+ * @details Every edge inside the component whose source is placed after its target in
+ * the ordering is backwards and thus belongs to the feedback arc set. The function
+ * first fills the position array from the ordering and then scans the edges inside the
+ * component once, edges to other components never belong to a minimal feedback arc
+ * set. The scan stops as soon as the number of backward edges reaches the bound.
+ * @param Graph_ptr Pointer to a Graph_ptr struct.
+ * @param scc Pointer to the Graph_scc struct of the graph.
+ * @param c The component.
+ * @param order Array of the vertices of the component in the order to be evaluated.
+ * @param pos Array of graph_vertex_count() integers used to store the position of each vertex.
+ * @param fb_set Edge structures array receiving the backward edges, at least bound elements long.
+ * @param bound Number of backward edges after which the evaluation is aborted.
+ * @return Returns the size of the feedback arc set, or bound if the evaluation was aborted.
+ */
+int graph_component_fb_set(Graph_ptr g, const Graph_scc *scc, int c, const int *order, int *pos, Edge fb_set[], int bound);
+
+/**
+ * Exact component feedback arc set function.
+ * @brief This function finds a minimum feedback arc set of a small component.
+ * @details The vertices are ordered by dynamic programming over the subsets of the
+ * component: the best ordering of a subset ends with one of its vertices, placed after
+ * the best ordering of the rest, and its edges to the rest point backwards. This takes
+ * O(2^n n) time and O(2^n) memory, hence the component must not have more than
+ * EXACT_MAX_VERTICES vertices.
+ * @param Graph_ptr Pointer to a Graph_ptr struct.
+ * @param scc Pointer to the Graph_scc struct of the graph.
+ * @param c The component.
+ * @param fb_set Edge structures array receiving the minimum feedback arc set, at least
+ * as long as the component has edges.
+ * @return Returns the size of the minimum feedback arc set.
+ */
+int graph_component_exact_fb_set(Graph_ptr g, const Graph_scc *scc, int c, Edge fb_set[]);
+
+/** 
+ * ---------------------------------------------------------------------------------
+ *                             Graph input function declarations
+ * --------------------------------------------------------------------------------- 
+ */
+
+/**
+ * Edge list initialization function.
+ * @brief This function initializes an empty Edge_list.
+ * @param list Pointer to an Edge_list struct.
+ * @return none
+ */
+void edge_list_init(Edge_list *list);
+
+/**
+ * Edge list append function.
+ * @brief This function appends a directed edge to an Edge_list.
+ * @details The edges array is grown by doubling its capacity when it is full.
+ * @param list Pointer to an Edge_list struct.
+ * @param src Source vertex label.
+ * @param trgt Target vertex label.
+ * @return none
+ */
+void edge_list_push(Edge_list *list, Label src, Label trgt);
+
+/**
+ * Edge list destruction function.
+ * @brief This function frees the edges of an Edge_list and leaves it empty.
+ * @param list Pointer to an Edge_list struct.
+ * @return none
+ */
+void edge_list_free(Edge_list *list);
+
+/**
+ * Format name function.
+ * @brief This function translates a format name into a Graph_format.
+ * @param name One of "auto", "edges", "dimacs", "metis" or "fasg".
+ * @param fmt Pointer to the Graph_format receiving the format.
+ * @return Returns 1 if the name is a known format, 0 otherwise.
+ */
+int format_from_name(const char *name, Graph_format *fmt);
+
+/**
+ * Edge from argument function.
+ * @brief This function parses an edge argument formatted as <source>-<target>.
+ * @details The function validates the format and extracts both vertex labels in a
+ * single pass over the argument, the labels must be non-negative integers which fit
+ * into a Label.
+ * @param arg Argument to be parsed.
+ * @param src Pointer to the Label receiving the source vertex label.
+ * @param trgt Pointer to the Label receiving the target vertex label.
+ * @return Returns 1 if the argument is formatted correctly, 0 otherwise.
+ */
+int edge_from_arg(const char *arg, Label *src, Label *trgt);
+
+/**
+ * Load edges function.
+ * @brief This function reads the edges of a graph from a stream into an Edge_list.
+ * @details The function supports edge lists with one <source>-<target> or
+ * <source> <target> pair per line, DIMACS style "a <source> <target>" arc lines and METIS
+ * adjacency lists, in which the i-th line after the header lists the successors of
+ * vertex i. With FORMAT_AUTO, DIMACS or an edge list is detected from the first line.
+ * On malformed input an error message with the line number is printed and the program
+ * is terminated.
+ * @param in Stream to read the graph from, e.g. an opened file or stdin.
+ * @param fmt Format of the input.
+ * @param list Pointer to an initialized Edge_list struct the edges are appended to.
+ * @param stats Pointer to an Input_stats struct receiving the statistics, or NULL.
+ * @return none
+ */
+void load_edges(FILE *in, Graph_format fmt, Edge_list *list, Input_stats *stats);
+
+/**
+ * Load edges file function.
+ * @brief This function reads the edges of a graph from a file into an Edge_list.
+ * @details The function maps the file into memory and parses it without copying the
+ * lines. Edge lists and DIMACS files are split into chunks at newline boundaries which
+ * are parsed in parallel by up to PARSE_MAX_THREADS threads, one per PARSE_MIN_CHUNK
+ * bytes and online CPU. Files which cannot be mapped, such as pipes, are read with
+ * load_edges() instead. The formats and the error handling are the same as for
+ * load_edges().
+ * @param path Path of the graph file.
+ * @param fmt Format of the input.
+ * @param list Pointer to an initialized Edge_list struct the edges are appended to.
+ * @param stats Pointer to an Input_stats struct receiving the statistics, or NULL.
+ * @return none
+ */
+void load_edges_file(const char *path, Graph_format fmt, Edge_list *list, Input_stats *stats);
+
+/**
+ * Graph load function.
+ * @brief This function builds a finalized Graph_ptr from an Edge_list.
+ * @details The function maps the labels of the edges to dense vertex indices, adds
+ * all edges to a new graph and finalizes it. The Label_map is needed to translate
+ * the vertex indices back to labels and must be destroyed by the caller.
+ * @param list Pointer to an Edge_list struct.
+ * @param map Pointer to the Label_map pointer receiving the created Label_map.
+ * @return Returns a pointer to a finalized Graph_ptr struct.
+ */
+Graph_ptr graph_load(const Edge_list *list, Label_map **map);
+
+/**
+ * Graph fingerprint function.
+ * @brief This function computes a 64 bit fingerprint of a finalized Graph_ptr.
+ * @details The fingerprint covers the vertex labels and the successors lists, hence two
+ * graphs with the same fingerprint are the same instance with overwhelming probability.
+ * @param Graph_ptr Pointer to a finalized Graph_ptr struct.
+ * @param map Pointer to the Label_map of the graph.
+ * @return Returns the fingerprint of the graph.
+ */
+uint64_t graph_fingerprint(Graph_ptr, Label_map *map);
+
+/**
+ * Binary graph size function.
+ * @brief This function gives the size of the binary graph image of a finalized Graph_ptr.
+ * @param Graph_ptr Pointer to a finalized Graph_ptr struct.
+ * @return Returns the size of the binary graph image in bytes.
+ */
+size_t graph_fasg_size(Graph_ptr);
+
+/**
+ * Store binary graph function.
+ * @brief This function stores the binary graph image of a finalized Graph_ptr in memory.
+ * @details The image has the same layout as a binary graph file, see Fasg_header.
+ * @param Graph_ptr Pointer to a finalized Graph_ptr struct.
+ * @param map Pointer to the Label_map of the graph.
+ * @param dst Pointer to at least graph_fasg_size() bytes of memory, aligned for a Label.
+ * @return Returns the fingerprint stored in the image.
+ */
+uint64_t graph_store_fasg(Graph_ptr, Label_map *map, void *dst);
+
+/**
+ * Write binary graph file function.
+ * @brief This function writes a finalized Graph_ptr to a binary graph file.
+ * @details The file consists of a Fasg_header followed by the labels, the row offsets
+ * and the targets of the graph, see Fasg_header. On failure an error message is printed
+ * and the program is terminated.
+ * @param Graph_ptr Pointer to a finalized Graph_ptr struct.
+ * @param map Pointer to the Label_map of the graph.
+ * @param path Path of the file to be written, "-" for stdout.
+ * @return none
+ */
+void graph_write_fasg(Graph_ptr, Label_map *map, const char *path);
+
+/**
+ * Map binary graph file function.
+ * @brief This function maps a binary graph file into memory as a finalized Graph_ptr.
+ * @details The successors lists and labels are used directly from the read-only mapping
+ * of the file, no parsing or copying takes place. The file must have the layout which
+ * graph_write_fasg() writes, and its rows are checked once in O(V+E) for offsets in
+ * order and targets in range. On an invalid file an error message is printed and the
+ * program is terminated. The Label_map must be destroyed before or
+ * along with the graph, which unmaps the file.
+ * @param path Path of the binary graph file.
+ * @param map Pointer to the Label_map pointer receiving the Label_map of the graph.
+ * @return Returns a pointer to a finalized Graph_ptr struct.
+ */
+Graph_ptr graph_map_fasg(const char *path, Label_map **map);
+
+/**
+ * Attach shared graph function.
+ * @brief This function maps a binary graph image published in shared memory.
+ * @details The shared memory object is opened read-only and mapped like a binary graph
+ * file, see graph_map_fasg(). On failure an error message is printed and the program
+ * is terminated.
+ * @param shm_name Name of the shared memory object holding the binary graph image.
+ * @param map Pointer to the Label_map pointer receiving the Label_map of the graph.
+ * @return Returns a pointer to a finalized Graph_ptr struct.
+ */
+Graph_ptr graph_attach_shm(const char *shm_name, Label_map **map);
+
+/**
+ * Graph read function.
+ * @brief This function reads a graph file in any of the supported formats.
+ * @details Binary graph files are mapped with graph_map_fasg(), text inputs are read
+ * with load_edges_file() (or load_edges() for stdin) and built with graph_load(). An
+ * input without any edges is reported as an error.
+ * @param path Path of the graph file, "-" for stdin.
+ * @param fmt Format of the input, FORMAT_AUTO also recognizes binary graph files.
+ * @param map Pointer to the Label_map pointer receiving the Label_map of the graph.
+ * @param stats Pointer to an Input_stats struct receiving the statistics, or NULL.
+ * @return Returns a pointer to a finalized Graph_ptr struct.
+ */
+Graph_ptr graph_read(const char *path, Graph_format fmt, Label_map **map, Input_stats *stats);
+
+/** 
+ * ---------------------------------------------------------------------------------
+ *                             Label_map function declarations
+ * --------------------------------------------------------------------------------- 
+ */
+
+/**
+ * Label map creation function.
+ * @brief This function creates a Label_map from a set of external vertex labels.
+ * @details The function sorts a copy of the labels with a least significant digit radix
+ * sort and drops duplicates, so that every distinct label is assigned a dense vertex
+ * index in 0..n-1 in expected linear time. Radix passes over bytes which are the same
+ * for all labels are skipped. If the index array is given, the dense vertex index of
+ * every passed label is stored in it, which spares the caller a lookup per label.
+ * @param labels Array of external vertex labels, may contain duplicates.
+ * @param size Size of the labels array.
+ * @param index Array of size integers receiving the dense index of each label, or NULL.
+ * @return Returns a pointer to a Label_map struct.
+ */
+Label_map *label_map_create(const Label *labels, size_t size, int *index);
+
+/**
+ * Label map destruction function.
+ * @brief This function destroys a Label_map.
+ * @param map Pointer to a Label_map struct.
+ * @return none
+ */
+void label_map_destroy(Label_map *map);
+
+/**
+ * Label map size function.
+ * @brief This function gives the number of distinct labels in a Label_map.
+ * @param map Pointer to a Label_map struct.
+ * @return Returns the number of dense vertex indices.
+ */
+int label_map_size(Label_map *map);
+
+/**
+ * Label to index function.
+ * @brief This function translates an external vertex label to its dense vertex index.
+ * @details The function performs a binary search on the sorted labels.
+ * @param map Pointer to a Label_map struct.
+ * @param label External vertex label.
+ * @return Returns the dense vertex index of the label, -1 if the label is unknown.
+ */
+int label_map_index(Label_map *map, Label label);
+
+/**
+ * Index to label function.
+ * @brief This function translates a dense vertex index back to its external vertex label.
+ * @param map Pointer to a Label_map struct.
+ * @param index Dense vertex index.
+ * @return Returns the external vertex label of the index.
+ */
+Label label_map_label(Label_map *map, int index);
+
+/** 
  * ---------------------------------------------------------------------------------
- *                             Semaphore function declarations
+ *                            Ring buffer function declarations
  * ---------------------------------------------------------------------------------
- *
- * Most of the functions are simply the standard semaphore functions
- * to which an appropriate level of error checking/handling was added.
+ * Every generator writes to a channel of its own, a single producer single consumer
+ * ring from which only the supervisor reads. Generators thus never contend with each
+ * other when they submit a solution.
  */
 
 /**
- * Open semaphore function.
- * @brief This function opens a semaphore and performs error checking.
- * @details The function relies on the standard semaphore function sem_open(3).
- * Additionally, after calling sem_open(), the function handles any errors if such
- * were to occur.
- * @param sem_name Semaphore name.
- * @param sem_size Semaphore size.
- * @param mode Mode of the semaphore. With 1: supervisor semaphore; 
- * 0: generator semaphore.
- * @return Returns a pointer to a semaphore if successful, an error message otherwise.
+ * Ring buffer size function.
+ * @brief This function returns the size of a ring buffer with the given capacities.
+ * @param channels Number of generator channels.
+ * @param slots Number of slots of every channel.
+ * @param best_e Number of edges of the best feedback arc set to be stored.
+ * @param best_v Number of vertices of the best ordering to be stored.
+ * @return Returns the size of the shared memory in bytes.
  */
-sem_t *open_sem(char *sem_name, size_t sem_size, int mode);
+size_t ring_size(int channels, int slots, int best_e, int best_v);
 
 /**
- * Get semaphore value function.
- * @brief This function places a semaphore value into an int and performs error checking.
- * @details The function relies on the standard semaphore function sem_getvalue(3).
- * Additionally, after calling sem_getvalue(), the function handles any errors if such
- * were to occur.
- * @param sem Semaphore pointer.
- * @param res Integer pointer to a variable in which the semaphore value is placed.
+ * Reserve ring buffer function.
+ * @brief This function marks a newly created ring buffer as owned by the supervisor.
+ * @details The version and the process id of the supervisor are written right after the
+ * shared memory has been created, so that another supervisor started while this one is
+ * still setting up the ring buffer doesn't take it for stale, see ring_stale().
+ * @param buf Pointer to the ring buffer.
  * @return none
  */
-void getval_sem(sem_t *sem, int *res);
+void ring_reserve(Buffer *buf);
 
 /**
- * Wait semaphore function.
- * @brief This function decrements a semaphore and performs error checking.
- * @details The function relies on the standard semaphore function sem_wait(3).
- * Additionally, after calling sem_wait(), the function handles any errors if such
- * were to occur.
- * @param sem Semaphore pointer.
+ * Init ring buffer function.
+ * @brief This function initializes an empty ring buffer.
+ * @details The header is filled in, all channels are freed and emptied and the best
+ * register is emptied. The magic of the header is written last, generators refuse to
+ * attach to the ring buffer before. The function must therefore be called by the
+ * supervisor once everything else in the buffer has been set up.
+ * @param buf Pointer to the ring buffer, mapped with ring_size() bytes.
+ * @param channels Number of generator channels.
+ * @param slots Number of slots of every channel.
+ * @param best_e Number of edges of the best feedback arc set to be stored.
+ * @param best_v Number of vertices of the best ordering to be stored.
+ * @param seed Master seed of the run.
  * @return none
  */
-void wait_sem(sem_t *sem);
+void ring_init(Buffer *buf, int channels, int slots, int best_e, int best_v, uint64_t seed);
 
 /**
- * Post semaphore function.
- * @brief This function increments a semaphore and performs error checking.
- * @details The function relies on the standard semaphore function sem_post(3).
- * Additionally, after calling sem_post(), the function handles any errors if such
- * were to occur.
- * @param sem Semaphore pointer.
+ * Attach ring buffer function.
+ * @brief This function maps the ring buffer which the supervisor has set up.
+ * @details The header is mapped first and checked for the magic, the version, the slot
+ * size of this program and a total size matching the capacities and the size of the
+ * shared memory object. Only then is the whole ring buffer mapped. Any mismatch is
+ * handled as an error.
+ * @param shm_name Name of the shared memory.
+ * @param shm_fd Set to the shared memory file descriptor.
+ * @return Returns a pointer to the ring buffer, which is header.size bytes large.
+ */
+Buffer *ring_attach(char *shm_name, int *shm_fd);
+
+/**
+ * Stale ring buffer function.
+ * @brief This function checks whether a ring buffer has been left behind by a supervisor.
+ * @details A supervisor which is killed with SIGKILL can't remove its shared memory. The
+ * ring buffer is stale if it exists, but either has another layout version, no owner
+ * yet or its supervisor, whose process id the header holds, doesn't exist anymore or is
+ * a zombie. A ring buffer which isn't set up completely is only stale in these cases.
+ * @param shm_name Name of the shared memory.
+ * @return Returns true if the ring buffer exists and is stale, false otherwise.
+ */
+bool ring_stale(char *shm_name);
+
+/**
+ * Ring channel function.
+ * @brief This function returns a channel of the ring buffer.
+ * @param buf Pointer to the ring buffer.
+ * @param index Index of the channel, less than header.channels.
+ * @return Returns a pointer to the channel.
+ */
+Channel *ring_channel(Buffer *buf, int index);
+
+/**
+ * Register channel function.
+ * @brief This function registers a generator for a free channel.
+ * @details The owner of the first free channel is claimed by a compare and swap, which
+ * makes the generator the only writer of the channel. Its start time is recorded next to
+ * the owner, see channel_orphaned().
+ * @param buf Pointer to the ring buffer.
+ * @param writer Process id of the generator.
+ * @return Returns a pointer to the channel, NULL if all channels are taken.
+ */
+Channel *channel_register(Buffer *buf, int writer);
+
+/**
+ * Release channel function.
+ * @brief This function frees the channel of a generator for the next generator.
+ * @details Parts still in the channel are read by the supervisor nevertheless.
+ * @param ch Pointer to the channel.
  * @return none
  */
-void post_sem(sem_t *sem);
+void channel_release(Channel *ch);
 
 /**
- * Close semaphore function.
- * @brief This function closes a sempahore and performs error checking.
- * @details The function relies on the standard semaphore function sem_close(3).
- * Additionally, after calling sem_close(), the function handles any errors if such
- * were to occur.
- * @param sem Semaphore pointer.
+ * Orphaned channel function.
+ * @brief This function checks whether the owner of a channel has terminated.
+ * @details Generators which are killed, e.g. by the OOM killer, never release their
+ * channel. The owner is looked up in /proc, it has terminated if it doesn't exist
+ * anymore, is a zombie or has another start time than the one recorded in the channel,
+ * i.e. its process id has been reused. Only the supervisor may call the function.
+ * @param ch Pointer to the channel.
+ * @return Returns the process id of the terminated owner, 0 if the channel is free or
+ * its owner still running.
+ */
+int channel_orphaned(Channel *ch);
+
+/**
+ * Reclaim channel function.
+ * @brief This function frees the channel of a terminated generator.
+ * @details The supervisor must read all parts of the channel before, since the next
+ * generator continues writing at the head of the channel. The owner is only reset if
+ * it is still the terminated generator.
+ * @param ch Pointer to the channel.
+ * @param owner Process id of the terminated generator.
  * @return none
  */
-void close_sem(sem_t *sem);
+void channel_reclaim(Channel *ch, int owner);
+
+/**
+ * Ring stream function.
+ * @brief This function hands out a random number stream of the run to a generator.
+ * @details Every call returns another stream number, the streams of a run are seeded
+ * with stream_seed() from the master seed in the ring buffer.
+ * @param buf Pointer to the ring buffer.
+ * @return Returns the stream number.
+ */
+uint64_t ring_stream(Buffer *buf);
+
+/**
+ * Claim slot function.
+ * @brief This function reserves the slot at the head of a channel for writing.
+ * @details The generator writes the part directly into the slot, which the supervisor
+ * doesn't read before it is committed. The function never blocks, only the owner of
+ * the channel may call it.
+ * @param buf Pointer to the ring buffer.
+ * @param ch Pointer to the channel.
+ * @return Returns a pointer to the slot, NULL if the channel is full.
+ */
+Fb_arc_set *channel_claim(Buffer *buf, Channel *ch);
+
+/**
+ * Commit slot function.
+ * @brief This function publishes the slot claimed last by advancing the head.
+ * @param ch Pointer to the channel.
+ * @return none
+ */
+void channel_commit(Channel *ch);
+
+/**
+ * Peek slot function.
+ * @brief This function returns the slot at the tail of a channel for reading.
+ * @details The supervisor reads the part directly from the slot, which the generator
+ * doesn't overwrite before it is consumed. Since the slot lies in shared memory, its
+ * fields must be validated before they are used. Only the supervisor may call the
+ * function.
+ * @param buf Pointer to the ring buffer.
+ * @param ch Pointer to the channel.
+ * @return Returns a pointer to the slot, NULL if the channel is empty.
+ */
+const Fb_arc_set *channel_peek(Buffer *buf, Channel *ch);
+
+/**
+ * Consume slot function.
+ * @brief This function releases the slot returned by the last peek by advancing the tail.
+ * @param ch Pointer to the channel.
+ * @return none
+ */
+void channel_consume(Channel *ch);
+
+/**
+ * Initialize backoff function.
+ * @brief This function initializes the backoff of the supervisor.
+ * @param b Pointer to a Ring_backoff struct.
+ * @return none
+ */
+void ring_backoff_init(Ring_backoff *b);
+
+/**
+ * Ring buffer backoff function.
+ * @brief This function waits before the ring buffer is polled again.
+ * @details The supervisor polls an idle ring buffer for the spin window of the backoff,
+ * the first RING_SPINS polls right away and the following ones after yielding the
+ * processor. After that it parks on the futex word of the ring buffer until a generator
+ * wakes it up, for at most RING_PARK_MS. Only the supervisor may call the function.
+ * @param buf Pointer to the ring buffer.
+ * @param b Pointer to the backoff, whose poll counter is incremented.
+ * @return none
+ */
+void ring_backoff(Buffer *buf, Ring_backoff *b);
+
+/**
+ * Ring buffer arrival function.
+ * @brief This function resets the backoff once parts arrived in the ring buffer.
+ * @details The time the ring buffer was idle enters the moving average of the idle
+ * times, from which the spin window is derived: twice the average, between
+ * RING_SPIN_MIN_NS and RING_SPIN_MAX_NS. If the ring buffer is usually idle longer
+ * than RING_SPIN_MAX_NS, spinning rarely pays off and the window is RING_SPIN_MIN_NS.
+ * @param b Pointer to the backoff.
+ * @return none
+ */
+void ring_arrival(Ring_backoff *b);
+
+/**
+ * Ring buffer notify function.
+ * @brief This function wakes up the supervisor after parts were written to a channel.
+ * @details The futex is only woken if the supervisor is parked, so that a busy
+ * supervisor costs no system call. The first generator to notice a parked supervisor
+ * clears the flag, thus parts which land close together cause a single wakeup.
+ * @param buf Pointer to the ring buffer.
+ * @return none
+ */
+void ring_notify(Buffer *buf);
+
+/**
+ * Best register function.
+ * @brief This function returns the size of the best feedback arc set of the register.
+ * @details The size is read with a single atomic load, so the function is wait-free and
+ * can be called as often as needed.
+ * @param buf Pointer to the ring buffer.
+ * @return Returns the size of the best set published by the supervisor, INT_MAX if none.
+ */
+int best_size(Buffer *buf);
+
+/**
+ * Best bound function.
+ * @brief This function returns the size of the best set written to the ring buffer.
+ * @details Generators lower the bound as soon as they have written a set completely,
+ * before the supervisor has read it. Sets which aren't smaller can be discarded.
+ * @param buf Pointer to the ring buffer.
+ * @return Returns the bound, INT_MAX if no set has been written yet.
+ */
+int best_bound(Buffer *buf);
+
+/**
+ * Lower bound function.
+ * @brief This function lowers the bound to the size of a set written to the ring buffer.
+ * @details The bound is lowered by a compare and swap unless it is smaller already.
+ * @param buf Pointer to the ring buffer.
+ * @param num_e Size of the feedback arc set.
+ * @return none
+ */
+void best_lower_bound(Buffer *buf, int num_e);
+
+/**
+ * Publish best function.
+ * @brief This function stores a new best feedback arc set in the register.
+ * @details The register is written under its sequence lock, of which the supervisor
+ * must be the only writer. Edges and ordering are cut off at the capacities of the
+ * header.
+ * @param buf Pointer to the ring buffer.
+ * @param edges Label_edge structures array of the feedback arc set.
+ * @param num_e Size of the feedback arc set.
+ * @param order Labels of the vertices in an ordering without backward edges but those of the set.
+ * @param num_v Size of the ordering, 0 if none is known.
+ * @return none
+ */
+void best_publish(Buffer *buf, const Label_edge edges[], int num_e, const Label order[], int num_v);
+
+/**
+ * Read best function.
+ * @brief This function reads a consistent copy of the register.
+ * @details The register is copied until no write of the supervisor interfered, which
+ * readers detect from the sequence number. Readers never block the supervisor.
+ * @param buf Pointer to the ring buffer.
+ * @param edges Label_edge structures array of header.best_e elements, receiving the edges.
+ * @param order Array of header.best_v labels receiving the ordering.
+ * @param reg Best_register struct receiving the sizes.
+ * @return none
+ */
+void best_read(Buffer *buf, Label_edge edges[], Label order[], Best_register *reg);
+
 
 /** 
  * ---------------------------------------------------------------------------------
@@ -288,12 +897,24 @@ void close_sem(sem_t *sem);
  * @brief This function creates a shared memory object and performs error checking.
  * @details The function relies on the standard shared memory function shm_open(3).
  * Additionally, after calling shm_open(), the function handles any errors if such
- * were to occur.
+ * were to occur. An object of the same name must not exist, see ring_stale().
  * @param shm_name Name of the shared memory.
  * @return Returns an int shared memory file descriptor.
  */
 int create_shm(char *shm_name);
 
+/**
+ * Attach shared memory function.
+ * @brief This function opens an existing shared memory object and performs error checking.
+ * @details The function relies on the standard shared memory function shm_open(3) and
+ * fstat(2). The object must already exist and hold at least shm_size bytes, otherwise
+ * the function handles the error.
+ * @param shm_name Name of the shared memory.
+ * @param shm_size Minimal size of the shared memory.
+ * @return Returns an int shared memory file descriptor.
+ */
+int attach_shm(char *shm_name, size_t shm_size);
+
 /**
  * Truncate shared memory function.
  * @brief This function truncates a shared memory object and performs error checking.
@@ -12,8 +12,13 @@
  * passed to the shared memory ring buffer. In both cases, the termination of the 
  * generator program is preceeded by closing of all shared resources used by it.
  * 
- * USAGE: The generator takes at least one edge as arguments.
- * generator EDGE1 ...
+ * USAGE: The generator takes at least one edge as arguments or reads the graph from a
+ * file, "-" denoting stdin, in the given format (edges, dimacs, metis, fasg or auto).
+ * Binary graph files written by the converter are mapped without any parsing. Without
+ * a graph, the generator attaches to the graph published by the supervisor.
+ * The search runs in the given number of threads, which share the graph.
+ * generator [--stats] [--threads N] [EDGE1 ...]
+ * generator [--stats] [--threads N] [-t FORMAT] -f FILE
  */
 
 #include "fb_arc_set.h"
@@ -30,36 +35,82 @@ static int shm_buf_fd;
 static Buffer *ring_buf;
 
 /**
- * @brief Definition of the three semaphores needed for the fb_arc_set assignment.
+ * @brief The channel of the ring buffer to which only this generator writes.
  */
-static sem_t *excl_sem;
-static sem_t *used_sem;
-static sem_t *free_sem;
+static Channel *channel;
+
+/**
+ * @brief The best fb arc set of the generator, which is yet to be written to the ring buffer.
+ */
+static Fb_mailbox mailbox;
+
+/**
+ * @brief The lock of the mailbox shared by the search threads, and the size of the best
+ * fb arc set put into it, which is only accessed under the lock.
+ */
+static pthread_mutex_t mailbox_lock = PTHREAD_MUTEX_INITIALIZER;
+static int mailbox_best = INT_MAX;
+
+/**
+ * @brief The graph and its labels shared by the search threads, and the process id which
+ * identifies the parts of the fb arc sets of this generator.
+ */
+static Graph_ptr graph;
+static Label_map *graph_labels;
+static int writer;
+
+/**
+ * @brief The strongly connected components of the graph, which are searched separately,
+ * and the best fb arc sets of the components shared by the search threads. The sets and
+ * their sizes are written under the lock, the search threads read the size of the
+ * component they search without it to bound the evaluation of an ordering.
+ */
+static Graph_scc *scc;
+static pthread_mutex_t comp_lock = PTHREAD_MUTEX_INITIALIZER;
+static int *comp_best;
+static Edge *comp_edges;
+
+/**
+ * @brief The search threads and the number of their tasks which aren't retired yet.
+ */
+static Search_worker *workers;
+static int num_workers;
+static int live_tasks;
+
+/**
+ * @brief The threads which ran out of tasks park on the condition variable until a task
+ * is queued or retired, the number of parked threads is read without the lock.
+ */
+static pthread_mutex_t idle_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t idle_cond = PTHREAD_COND_INITIALIZER;
+static int idle_workers;
 
 /**
  * Free before exit function.
  * @brief This function frees up the occupied shared ressources.
  * @details The function is used in the signal handling of SIGKILL and SIGTERM.
  * After such a signal has been sent by the user, this function ensures that
- * the generator(s) close the free space, used space and mutual exclusion semaphores
- * which they opened and also unmap the shared memory ring buffer.
+ * the generator(s) unmap the shared memory ring buffer.
  * @param none
  * @return none
  */
 static void free_before_exit(void)
 {
-    close_sem(free_sem);
-    sem_unlink(FREE_SEM);
-
-    close_sem(used_sem);
-    sem_unlink(USED_SEM);
+    /**
+     * An error before the ring buffer is mapped terminates the generator with nothing
+     * to be closed. The generator doesn't unlink it, since it belongs to the supervisor.
+     */
+    if (channel != NULL)
+        channel_release(channel);
 
-    close_sem(excl_sem);
-    sem_unlink(EXCL_SEM);
+    if (ring_buf != NULL)
+    {
+        unmap_shm(ring_buf, ring_buf->header.size);
+        close(shm_buf_fd);
+    }
 
-    unmap_shm(ring_buf, sizeof(Buffer));
-    shm_unlink(RING_BUF);
-    close(shm_buf_fd);
+    free(mailbox.edges);
+    free(mailbox.next);
 }
 
 /**
@@ -92,13 +143,432 @@ void process_signal(void)
     sigaction(SIGTERM, &sa, NULL);
 }
 
+/**
+ * Submit mailbox function.
+ * @brief This function writes the pending fb arc set of the mailbox to the ring buffer.
+ * @details The fb arc set is written to the channel of the generator in parts of at
+ * most SLOT_EDGES edges, which the supervisor reassembles. Every part is written
+ * directly into the claimed slot. The function never waits for the supervisor: once
+ * the channel is full, the remaining parts stay in the mailbox and are written by a
+ * later call. A set is always written completely once its first part is in the
+ * channel, else frequent improvements would keep any set from being completed, after
+ * that the next set is written. The supervisor is woken up once per call, not once per
+ * part.
+ * @param labels The labels of the graph vertices.
+ * @param writer The process id of the generator.
+ * @return Returns true if the whole set has been written, false otherwise.
+ */
+static bool submit_mailbox(Label_map *labels, int writer)
+{
+    int written = 0;
+
+    for (;;)
+    {
+        Fb_arc_set *slot = channel_claim(ring_buf, channel);
+        if (slot == NULL)
+        {
+            if (written > 0)
+                ring_notify(ring_buf);
+            return false;
+        }
+
+        int count = mailbox.num_e - mailbox.first < SLOT_EDGES ? mailbox.num_e - mailbox.first : SLOT_EDGES;
+        slot->writer = writer;
+        slot->num_e = mailbox.num_e;
+        slot->first = mailbox.first;
+        slot->count = count;
+
+        for (int i = 0; i < count; ++i)
+        {
+            slot->edges[i].src = label_map_label(labels, mailbox.edges[mailbox.first + i].src);
+            slot->edges[i].trgt = label_map_label(labels, mailbox.edges[mailbox.first + i].trgt);
+        }
+        channel_commit(channel);
+
+        written++;
+        mailbox.first += count;
+        if (mailbox.first < mailbox.num_e)
+            continue;
+
+        best_lower_bound(ring_buf, mailbox.num_e);
+
+        if (!mailbox.has_next)
+            break;
+
+        Edge *swap = mailbox.edges;
+        mailbox.edges = mailbox.next;
+        mailbox.next = swap;
+        mailbox.num_e = mailbox.next_num_e;
+        mailbox.first = 0;
+        mailbox.has_next = false;
+    }
+
+    __atomic_store_n(&mailbox.pending, false, __ATOMIC_RELEASE);
+    ring_notify(ring_buf);
+    return true;
+}
+
+/**
+ * Offer mailbox function.
+ * @brief This function puts a better fb arc set of a search thread into the mailbox.
+ * @details The set replaces a pending one in the mailbox unless that one is partly
+ * written already, in which case it becomes the next set. The set is only taken if it
+ * is better than all sets the other threads put into the mailbox. The buffers are
+ * swapped instead of copying the set, the thread continues with the one it gets back.
+ * @param edge_set Pointer to the edges array of the thread, replaced by a free one.
+ * @param fb_size Size of the fb arc set.
+ * @return Returns true if the set was taken, false otherwise.
+ */
+static bool offer_mailbox(Edge **edge_set, int fb_size)
+{
+    pthread_mutex_lock(&mailbox_lock);
+
+    if (fb_size >= mailbox_best)
+    {
+        pthread_mutex_unlock(&mailbox_lock);
+        return false;
+    }
+    mailbox_best = fb_size;
+
+    Edge *swap;
+    if (mailbox.pending && mailbox.first > 0)
+    {
+        swap = mailbox.next;
+        mailbox.next = *edge_set;
+        mailbox.next_num_e = fb_size;
+        mailbox.has_next = true;
+    }
+    else
+    {
+        swap = mailbox.edges;
+        mailbox.edges = *edge_set;
+        mailbox.num_e = fb_size;
+        mailbox.first = 0;
+        __atomic_store_n(&mailbox.pending, true, __ATOMIC_RELEASE);
+    }
+    *edge_set = swap;
+
+    submit_mailbox(graph_labels, writer);
+    pthread_mutex_unlock(&mailbox_lock);
+    return true;
+}
+
+/**
+ * Wake idle function.
+ * @brief This function wakes up the search threads parked for a task.
+ * @details The lock is only taken if a thread is parked. A thread counts itself as
+ * parked before it looks for a task a last time, hence it either finds the task queued
+ * or it is woken up.
+ * @param all Whether all threads are woken up, else only one of them.
+ * @return none
+ */
+static void wake_idle(bool all)
+{
+    if (__atomic_load_n(&idle_workers, __ATOMIC_SEQ_CST) == 0)
+        return;
+
+    pthread_mutex_lock(&idle_lock);
+    if (all)
+        pthread_cond_broadcast(&idle_cond);
+    else
+        pthread_cond_signal(&idle_cond);
+    pthread_mutex_unlock(&idle_lock);
+}
+
+/**
+ * Push task function.
+ * @brief This function queues a task at the end of a deque.
+ * @details A thread parked for a task is woken up to steal it.
+ * @param deque Pointer to the Task_deque.
+ * @param task The task.
+ * @return none
+ */
+static void deque_push(Task_deque *deque, Search_task task)
+{
+    pthread_mutex_lock(&deque->lock);
+
+    if (deque->size == deque->cap)
+    {
+        int cap = deque->cap > 0 ? 2 * deque->cap : 4;
+        Search_task *tasks = malloc(sizeof(Search_task) * cap);
+        assert(tasks);
+        for (int i = 0; i < deque->size; i++)
+            tasks[i] = deque->tasks[(deque->head + i) % deque->cap];
+        free(deque->tasks);
+        deque->tasks = tasks;
+        deque->cap = cap;
+        deque->head = 0;
+    }
+    deque->tasks[(deque->head + deque->size) % deque->cap] = task;
+    deque->size++;
+
+    pthread_mutex_unlock(&deque->lock);
+    wake_idle(false);
+}
+
+/**
+ * Take task function.
+ * @brief This function takes a task from a deque.
+ * @param deque Pointer to the Task_deque.
+ * @param task Pointer to the task receiving the one taken.
+ * @param steal Whether the task queued last is stolen, else the one queued first is taken.
+ * @return Returns true if a task was taken, false if the deque is empty.
+ */
+static bool deque_take(Task_deque *deque, Search_task *task, bool steal)
+{
+    bool taken = false;
+
+    pthread_mutex_lock(&deque->lock);
+    if (deque->size > 0)
+    {
+        if (steal)
+            *task = deque->tasks[(deque->head + deque->size - 1) % deque->cap];
+        else
+        {
+            *task = deque->tasks[deque->head];
+            deque->head = (deque->head + 1) % deque->cap;
+        }
+        deque->size--;
+        taken = true;
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    return taken;
+}
+
+/**
+ * Next task function.
+ * @brief This function finds the next task of a search thread.
+ * @details The thread takes the task it queued first, so that it runs its tasks in
+ * turns. If it has none left, it steals the one queued last from the other threads in
+ * turn.
+ * @param worker Pointer to the Search_worker struct of the thread.
+ * @param task Pointer to the task receiving the one found.
+ * @return Returns true if a task was found, false otherwise.
+ */
+static bool next_task(Search_worker *worker, Search_task *task)
+{
+    if (deque_take(&worker->deque, task, false))
+        return true;
+
+    for (int i = 1; i < num_workers; i++)
+    {
+        if (deque_take(&workers[(worker->id + i) % num_workers].deque, task, true))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Wait task function.
+ * @brief This function parks a search thread which ran out of tasks.
+ * @details The thread parks on the condition variable until a task is queued or
+ * retired, but at most SEARCH_PARK_MS milliseconds, so that it notices the termination
+ * of the generator, and then looks for a task again.
+ * @param worker Pointer to the Search_worker struct of the thread.
+ * @param task Pointer to the task receiving the one found.
+ * @return Returns true if a task was found, false otherwise.
+ */
+static bool wait_task(Search_worker *worker, Search_task *task)
+{
+    struct timespec deadline;
+    bool found;
+
+    pthread_mutex_lock(&idle_lock);
+    __atomic_add_fetch(&idle_workers, 1, __ATOMIC_SEQ_CST);
+
+    found = next_task(worker, task);
+    if (!found && __atomic_load_n(&live_tasks, __ATOMIC_SEQ_CST) > 0)
+    {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += SEARCH_PARK_MS * 1000000L;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+        deadline.tv_nsec %= 1000000000L;
+        pthread_cond_timedwait(&idle_cond, &idle_lock, &deadline);
+        found = next_task(worker, task);
+    }
+
+    __atomic_sub_fetch(&idle_workers, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&idle_lock);
+    return found;
+}
+
+/**
+ * Retire task function.
+ * @brief This function retires a task whose component needs no further search.
+ * @details Once the last task is retired, all parked threads are woken up to terminate.
+ * @param none
+ * @return none
+ */
+static void retire_task(void)
+{
+    if (__atomic_sub_fetch(&live_tasks, 1, __ATOMIC_SEQ_CST) == 0)
+        wake_idle(true);
+}
+
+/**
+ * Improve component function.
+ * @brief This function stores a better fb arc set of a component and offers the union.
+ * @details The set is only stored if it is still better than the best one of the
+ * component, which another thread may have improved meanwhile. The union of the best
+ * sets of all components is then gathered in the edges array of the thread and offered
+ * to the mailbox, unless another generator has written a better set already.
+ * @param c The component.
+ * @param comp_set The fb arc set of the component.
+ * @param fb_size Size of the fb arc set of the component.
+ * @param edge_set Pointer to the edges array of the thread, replaced by a free one.
+ * @return none
+ */
+static void improve_component(int c, const Edge comp_set[], int fb_size, Edge **edge_set)
+{
+    int size = 0;
+
+    pthread_mutex_lock(&comp_lock);
+    if (fb_size >= comp_best[c])
+    {
+        pthread_mutex_unlock(&comp_lock);
+        return;
+    }
+
+    memcpy(comp_edges + scc->edge_offsets[c], comp_set, sizeof(Edge) * fb_size);
+    __atomic_store_n(&comp_best[c], fb_size, __ATOMIC_RELAXED);
+
+    for (int i = 0; i < scc->count; i++)
+    {
+        memcpy(*edge_set + size, comp_edges + scc->edge_offsets[i], sizeof(Edge) * comp_best[i]);
+        size += comp_best[i];
+    }
+    pthread_mutex_unlock(&comp_lock);
+
+    int bound = best_bound(ring_buf);
+    if (size < bound && offer_mailbox(edge_set, size))
+        fprintf(stdout, "Buffer: %d, Calculated: %d\n", bound, size);
+}
+
+/**
+ * Component task function.
+ * @brief This function sets up a search task of a component.
+ * @details A component of up to EXACT_MAX_VERTICES vertices is solved exactly. A
+ * restart task of a larger one evaluates as many orderings per run as make up about
+ * TASK_WORK vertices and edges.
+ * @param c The component.
+ * @return Returns the task.
+ */
+static Search_task component_task(int c)
+{
+    int n = scc->offsets[c + 1] - scc->offsets[c];
+    int work = n + scc->edge_offsets[c + 1] - scc->edge_offsets[c];
+    Search_task task = {c, TASK_WORK / work > 0 ? TASK_WORK / work : 1, n <= EXACT_MAX_VERTICES};
+    return task;
+}
+
+/**
+ * Search function.
+ * @brief This function runs the search of a thread of the generator.
+ * @details The thread runs the tasks of the generator, its own ones first and then
+ * those it steals from other threads. A small component is solved exactly by its only
+ * task, after which the task is retired. A restart task shuffles the vertices of its
+ * component with the random number generator of the thread and evaluates the ordering,
+ * as many times as its rounds, and is queued again at the thread until the component
+ * is solved optimally with a single edge. A thread which runs out of tasks parks until
+ * another thread queues or retires one. Better fb arc sets of a component are shared
+ * by all threads, their union goes through the mailbox. The rest of a set which didn't
+ * fit into the ring buffer is written by whichever thread gets hold of the mailbox
+ * first, the others don't wait for it.
+ * @param arg Pointer to the Search_worker struct of the thread.
+ * @return Returns NULL.
+ */
+static void *search(void *arg)
+{
+    Search_worker *worker = arg;
+    int num_v = graph_vertex_count(graph);
+    int num_e = graph_edge_count(graph);
+    int fb_size, best, c, n;
+    Search_task task;
+
+    int *vertex_set = malloc(sizeof(int) * (scc->size > 0 ? scc->size : 1));
+    int *vertex_pos = malloc(sizeof(int) * (num_v > 0 ? num_v : 1)); /**< position of each vertex in the shuffled vertex set */
+    Edge *edge_set = malloc(sizeof(Edge) * (num_e > 0 ? num_e : 1));
+    Edge *comp_set = malloc(sizeof(Edge) * (num_e > 0 ? num_e : 1)); /**< evaluated fb arc set of a component */
+    assert(vertex_set && vertex_pos && edge_set && comp_set);
+
+    memcpy(vertex_set, scc->vertices, sizeof(int) * scc->size);
+
+    while (quit != 1 && ring_buf->acyclic != true && ring_buf->quit != 1)
+    {
+        if (__atomic_load_n(&mailbox.pending, __ATOMIC_ACQUIRE))
+        {
+            if (pthread_mutex_trylock(&mailbox_lock) == 0)
+            {
+                if (mailbox.pending)
+                    submit_mailbox(graph_labels, writer);
+                pthread_mutex_unlock(&mailbox_lock);
+            }
+        }
+
+        /**
+         * A thread without a task parks until it gets one. Once all tasks are retired,
+         * the best set is optimal and nothing is left to do but writing it, which the
+         * main thread finishes while the others terminate.
+         */
+        if (!next_task(worker, &task) && !wait_task(worker, &task))
+        {
+            if (__atomic_load_n(&live_tasks, __ATOMIC_SEQ_CST) > 0)
+                continue;
+            if (worker->id != 0 || !__atomic_load_n(&mailbox.pending, __ATOMIC_ACQUIRE))
+                break;
+            sched_yield();
+            continue;
+        }
+
+        c = task.comp;
+        if (task.exact)
+        {
+            fb_size = graph_component_exact_fb_set(graph, scc, c, comp_set);
+            improve_component(c, comp_set, fb_size, &edge_set);
+            retire_task();
+            continue;
+        }
+
+        /**
+         * Check for edges applying the algorithm described in the task. Instead of probing
+         * every vertex pair, the position of each vertex in the shuffled set is recorded and
+         * the edges inside the component are scanned once. The evaluation stops
+         * preemptively if the best feedback arc set size of the component has already
+         * been reached.
+         */
+        n = scc->offsets[c + 1] - scc->offsets[c];
+        for (int r = 0; r < task.rounds && quit != 1; r++)
+        {
+            best = __atomic_load_n(&comp_best[c], __ATOMIC_RELAXED);
+            shuffle_vertex_set(vertex_set + scc->offsets[c], n, &worker->rng);
+
+            fb_size = graph_component_fb_set(graph, scc, c, vertex_set + scc->offsets[c], vertex_pos, comp_set, best);
+            if (fb_size < best)
+                improve_component(c, comp_set, fb_size, &edge_set);
+        }
+
+        if (__atomic_load_n(&comp_best[c], __ATOMIC_RELAXED) <= 1)
+            retire_task();
+        else
+            deque_push(&worker->deque, task);
+    }
+
+    free(vertex_set);
+    free(vertex_pos);
+    free(edge_set);
+    free(comp_set);
+    return NULL;
+}
+
 /**
  * Program entry point.
  * @brief This is the main program of the generator module.
  * @details The program performs all of the generator functions as described in the
  * task requirements. Initially, it checks that the generator program has been
- * called correctly, afterwards it sets up the graph and all shared memory objects and
- * semaphores. The main tasks are performed in the program loop which monitors if the
+ * called correctly, afterwards it attaches to the shared memory ring buffer and sets up
+ * the graph. The main tasks are performed by the search threads, the main thread being
+ * the first of them, in a loop which monitors if the
  * shared atomic variable "quit" is set to true or an acyclic result has been saved in
  * the shared memory ring buffer. The program uses a Monte carlo randomized algorithm to
  * shuffle the vertices and then pick generate a feedback arc set. All feedback arc sets
@@ -114,12 +584,50 @@ int main(int argc, char *argv[])
 {
     char *prog = argv[0];
 
-    int src, trgt;
-    int i, k;
+    int i, opt;
     int num_e;
     int num_v;
 
-    if (argc < 2)
+    char *path = NULL;
+    Graph_format fmt = FORMAT_AUTO;
+    bool print_stats = false;
+    long threads = 1;
+    char *end;
+
+    static struct option long_opts[] = {
+        {"stats", no_argument, NULL, 's'},
+        {"threads", required_argument, NULL, 'n'},
+        {NULL, 0, NULL, 0}};
+
+    while ((opt = getopt_long(argc, argv, "f:t:", long_opts, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 's':
+            print_stats = true;
+            break;
+        case 'n':
+            errno = 0;
+            threads = strtol(optarg, &end, 10);
+            if (errno != 0 || end == optarg || *end != '\0' || threads < 1 || threads > SEARCH_MAX_THREADS)
+            {
+                fprintf(stderr, "[%s] ERROR: The number of threads must be between 1 and %d!\n", prog, SEARCH_MAX_THREADS);
+                usage(prog);
+            }
+            break;
+        case 'f':
+            path = optarg;
+            break;
+        case 't':
+            if (!format_from_name(optarg, &fmt))
+                usage(prog);
+            break;
+        default:
+            usage(prog);
+        }
+    }
+
+    if (path != NULL && optind < argc)
     {
         usage(prog);
     }
@@ -133,198 +641,231 @@ int main(int argc, char *argv[])
     process_signal();
 
     /**
-     * Assume in worst memory case scenario, each edge introduces 2 new vertices.
-     * A type of a bipartite graph.
+     * Shared memory objects definitions.
+     */
+    ring_buf = ring_attach(RING_BUF, &shm_buf_fd);
+
+    channel = channel_register(ring_buf, getpid());
+    if (channel == NULL)
+    {
+        fprintf(stderr, "[%s] ERROR: All %" PRIu32 " channels are taken by other generators!\n", prog, ring_buf->header.channels);
+        exit(EXIT_FAILURE);
+    }
+
+    struct timespec ingest_start;
+    clock_gettime(CLOCK_MONOTONIC, &ingest_start);
+
+    /**
+     * Map the distinct labels to the dense vertex indices 0..num_v-1 used internally,
+     * labels are only translated back when a solution is written to the ring buffer.
      */
-    int max_set[2 * argc];
+    Label_map *labels;
+    Graph_ptr g;
+    Input_stats stats;
+    bool attached = path == NULL && optind >= argc;
 
-    for (i = 1, k = 0; i < argc; i++)
+    if (attached)
     {
-        if (!assert_edge_format(argv[i]))
+        /**
+         * Without a graph of its own, the generator attaches to the graph which the
+         * supervisor published in shared memory.
+         */
+        if (!ring_buf->graph_shared)
         {
-            fprintf(stderr, "[%s] ERROR: Edge parameter formatted incorrectly!\n", prog);
+            fprintf(stderr, "[%s] ERROR: No graph given and none published by the supervisor!\n", prog);
             usage(prog);
         }
-        src = src_from_arg(argv[i]);
-        trgt = trgt_from_arg(argv[i]);
-
-        if (!val_in_arr(src, max_set, k))
-            max_set[k++] = src;
-
-        if (!val_in_arr(trgt, max_set, k))
-            max_set[k++] = trgt;
+        g = graph_attach_shm(GRAPH_SHM, &labels);
+        stats.bytes = g->map_size;
+        stats.threads = 1;
+        stats.ms = elapsed_ms(&ingest_start);
     }
+    else if (path != NULL)
+    {
+        g = graph_read(path, fmt, &labels, &stats);
+    }
+    else
+    {
+        Edge_list list;
+        Label src, trgt;
+        edge_list_init(&list);
 
-    int vertex_set[k]; /**< very convenient since k depicts the number of elements due to the last indexing being k++ */
-    num_v = k;
-    num_e = argc - 1;
-
-    for (i = 0; i < num_v; i++)
-        vertex_set[i] = max_set[i];
+        for (i = optind; i < argc; i++)
+        {
+            if (!edge_from_arg(argv[i], &src, &trgt))
+            {
+                fprintf(stderr, "[%s] ERROR: Edge parameter formatted incorrectly!\n", prog);
+                usage(prog);
+            }
+            edge_list_push(&list, src, trgt);
+        }
+        stats.bytes = 0;
+        stats.threads = 1;
+        stats.ms = elapsed_ms(&ingest_start);
 
-    Graph_ptr g = graph_create(num_v);
+        g = graph_load(&list, &labels);
 
-    /**
-     * Assert the graph is created correctly.
-     */
-    assert(graph_vertex_count(g) == num_v);
-    assert(graph_edge_count(g) == 0);
+        /**
+         * Assert that all edges were created, duplicate edges are only counted once.
+         */
+        assert(graph_edge_count(g) <= list.num_e);
+        edge_list_free(&list);
+    }
 
     /**
-     * Create edges in the graph.
+     * All generators must work on the same graph, the first one to register its graph
+     * determines the instance unless the supervisor published one.
      */
-    for (i = 1; i < argc; i++)
+    if (!attached)
     {
-        src = src_from_arg(argv[i]);
-        trgt = trgt_from_arg(argv[i]);
+        uint64_t fingerprint = graph_fingerprint(g, labels);
+        uint64_t registered = 0;
+
+        /**
+         * On failure, registered holds the fingerprint of the graph which was first.
+         */
+        if (!__atomic_compare_exchange_n(&ring_buf->graph_fingerprint, &registered, fingerprint, false,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) &&
+            registered != fingerprint)
+        {
+            fprintf(stderr, "[%s] ERROR: The graph differs from the one the other generators work on!\n", prog);
+            exit(EXIT_FAILURE);
+        }
+    }
 
-        graph_add_edge(g, src, trgt);
+    if (print_stats)
+    {
+        fprintf(stdout, "[%s] Read %zu bytes with %d threads in %.3f ms (%.1f MB/s)\n",
+                prog, stats.bytes, stats.threads, stats.ms,
+                stats.ms > 0 ? stats.bytes / 1e6 / (stats.ms / 1e3) : 0.0);
     }
 
+    graph = g;
+    graph_labels = labels;
+    num_v = graph_vertex_count(g);
+    num_e = graph_edge_count(g);
+
+    fprintf(stdout, "[%s] Ingested %d vertices and %d edges in %.3f ms\n", prog, num_v, num_e, elapsed_ms(&ingest_start));
+
     /**
-     * Assert that all edges were created.
+     * Only the components on cycles are searched, the rest of the graph is acyclic.
      */
-    assert(graph_edge_count(g) == num_e);
-
-    srand(time(0)); /**< generate random seed, only once per generator */
+    scc = graph_scc_create(g);
+    fprintf(stdout, "[%s] Searching %d strongly connected components with %d vertices and %d edges\n",
+            prog, scc->count, scc->size, scc->edge_offsets[scc->count]);
 
     /**
-     * Initialize edges array and fb arc set counters.
+     * Initialize the mailbox and the search threads, of which the main thread is the
+     * first.
      */
-    Edge edge_set[num_e];
-    int fb_size = 0;
+    mailbox.edges = malloc(sizeof(Edge) * (num_e > 0 ? num_e : 1));
+    mailbox.next = malloc(sizeof(Edge) * (num_e > 0 ? num_e : 1));
+    mailbox.pending = false;
+    mailbox.has_next = false;
+    assert(mailbox.edges && mailbox.next);
 
-    int best_fb_size = num_e - 1; /**< worst case scenario */
-    int calc_fb_size = 0;
-    bool better_sol_ex = false;
+    writer = getpid();
 
     /**
-     * Shared memory objects definitions.
+     * The generator gets a random number stream of the run of its own, seeded apart from
+     * those of all other generators. Each thread gets a substream 2^128 numbers further
+     * into the stream than the one before it, hence the substreams never overlap.
      */
-    int write_at = 0;
-    shm_buf_fd = create_shm(RING_BUF);
-    ring_buf = (Buffer *)open_shm(shm_buf_fd, sizeof(Buffer));
+    Rng rng;
+    rng_seed(&rng, stream_seed(ring_buf->seed, ring_stream(ring_buf)));
+
+    workers = calloc(threads, sizeof(Search_worker));
+    assert(workers);
+    num_workers = threads;
+
+    for (i = 0; i < threads; i++)
+    {
+        workers[i].id = i;
+        workers[i].rng = rng;
+        pthread_mutex_init(&workers[i].deque.lock, NULL);
+        rng_jump(&rng);
+    }
 
     /**
-     * Semaphores definitions.
+     * Every component starts out with the fb arc set of its vertices in the order found,
+     * the union of which is offered right away. Small components get an exact task, large
+     * ones a restart task for every TASK_SPLIT_VERTICES vertices, but not more than there
+     * are threads. Restart tasks run until their component is solved optimally, hence
+     * the large components get further ones in turns while there are fewer of them than
+     * threads, or the threads left over would only be parked. The tasks are dealt to the
+     * threads in turns.
      */
-    excl_sem = open_sem(EXCL_SEM, 1, 1);
-    used_sem = open_sem(USED_SEM, 0, 1);
-    free_sem = open_sem(FREE_SEM, BUF_SIZE, 1);
+    comp_best = malloc(sizeof(int) * (scc->count > 0 ? scc->count : 1));
+    comp_edges = malloc(sizeof(Edge) * (num_e > 0 ? num_e : 1));
+    Edge *edge_set = malloc(sizeof(Edge) * (num_e > 0 ? num_e : 1));
+    int *vertex_pos = malloc(sizeof(int) * (num_v > 0 ? num_v : 1));
+    assert(comp_best && comp_edges && edge_set && vertex_pos);
 
-    while (quit != 1 && ring_buf->acyclic != true && ring_buf->quit != 1)
+    int fb_size = 0;
+    for (int c = 0; c < scc->count; c++)
     {
-        shuffle_vertex_set(vertex_set, num_v);
-
-        calc_fb_size = 0;
+        comp_best[c] = graph_component_fb_set(g, scc, c, scc->vertices + scc->offsets[c], vertex_pos,
+                                              comp_edges + scc->edge_offsets[c], INT_MAX);
+        memcpy(edge_set + fb_size, comp_edges + scc->edge_offsets[c], sizeof(Edge) * comp_best[c]);
+        fb_size += comp_best[c];
+    }
+    int bound = best_bound(ring_buf);
+    if (fb_size < bound && offer_mailbox(&edge_set, fb_size))
+        fprintf(stdout, "Buffer: %d, Calculated: %d\n", bound, fb_size);
+    free(edge_set);
+    free(vertex_pos);
+
+    int dealt = 0;
+    int restarts = 0;
+    for (int c = 0; c < scc->count; c++)
+    {
+        Search_task task = component_task(c);
+        int tasks = task.exact ? 1 : 1 + (scc->offsets[c + 1] - scc->offsets[c]) / TASK_SPLIT_VERTICES;
 
-        /**
-         * Check for edges applying the algorithm described in the task.
-         */
-        for (int i = 1, edge_set_i = 0; i < num_v; ++i)
-        {
-            for (int j = 0; j < i; ++j)
-            {
-                if (graph_has_edge(g, vertex_set[i], vertex_set[j]))
-                {
-                    edge_set[edge_set_i].src = vertex_set[i];
-                    edge_set[edge_set_i].trgt = vertex_set[j];
-                    ++edge_set_i;
-                    ++calc_fb_size;
-                }
-            }
-            /**
-             * Stop preemptively if the best local feedback arc set size has already
-             * been reached.
-             */
-            if (calc_fb_size >= best_fb_size)
-            {
-                better_sol_ex = true;
-                break;
-            }
-        }
-        if (better_sol_ex)
-        {
-            better_sol_ex = false;
+        if (comp_best[c] <= 1)
             continue;
-        }
-
-        fb_size = calc_fb_size;
-
-        /**
-         * A better feedback arc set than the best local one has been found.
-         */
-        if (best_fb_size > fb_size && fb_size <= MAX_VIABLE_COUNT)
+        for (int t = 0; t < tasks && t < threads; t++)
         {
-            fprintf(stdout, "Buffer: %d, Calculated: %d\n", ring_buf->best_fb_size, fb_size);
-            /**
-             * The fb arc set was found, but the ring buffer already holds a better solution.
-             */
-            if (fb_size > ring_buf->best_fb_size)
-            {
-                best_fb_size = ring_buf->best_fb_size;
-                continue;
-            }
-            best_fb_size = fb_size;
-
-            Fb_arc_set fb_arc_set;
-            memset(&fb_arc_set, 0, sizeof(Fb_arc_set));
-
-            for (int i = 0; i < best_fb_size; ++i)
-            {
-                fb_arc_set.edges[i].src = edge_set[i].src;
-                fb_arc_set.edges[i].trgt = edge_set[i].trgt;
-            }
-
-            /**
-		     * Used in the creation/debugging stage. Is now obsolete.
-		     *
-             * @code
-             * fprintf(stdout, "Solution found:");
-             * for (int i = 0; i < best_fb_size; ++i)
-             * {
-             *  fprintf(stdout, " %d->%d", fb_arc_set.edges[i].src, fb_arc_set.edges[i].trgt);
-             * }
-             * fprintf(stdout, "\n");
-             * @endcode
-             */
-
-            fb_arc_set.written = true;
-            fb_arc_set.num_e = best_fb_size;
-
-            wait_sem(excl_sem); /**< wait for/block other generators by decrementing the exclusion semaphore */
-
-            /**
-             * Decrement the free space semaphore.
-             * If buffer is full, block the write operation until buffer has space.
-             */
-            wait_sem(free_sem);
-
-            /**
-             * Find a position in the ring buffer which isn't written to.
-             */
-            while (ring_buf->sets[write_at].written == true)
-            {
-                write_at = (write_at + 1) % BUF_SIZE;
-            }
+            deque_push(&workers[dealt++ % threads].deque, task);
+            live_tasks++;
+            restarts += !task.exact;
+        }
+    }
 
-            ring_buf->sets[write_at] = fb_arc_set;
+    for (int c = 0; restarts > 0 && restarts < threads; c = (c + 1) % scc->count)
+    {
+        Search_task task = component_task(c);
 
-            post_sem(used_sem); /**< buffer now holds one more element, increment the used space semaphore */
+        if (comp_best[c] <= 1 || task.exact)
+            continue;
+        deque_push(&workers[dealt++ % threads].deque, task);
+        live_tasks++;
+        restarts++;
+    }
 
-            write_at = (write_at + 1) % BUF_SIZE;
+    for (i = 1; i < threads; i++)
+    {
+        if (pthread_create(&workers[i].thread, NULL, search, &workers[i]) != 0)
+        {
+            fprintf(stderr, "[%s] ERROR: Failed creating the search threads!\n", prog);
+            exit(EXIT_FAILURE);
+        }
+    }
+    search(&workers[0]);
 
-            post_sem(excl_sem); /**< unblock other generators wanting to write */
+    for (i = 1; i < threads; i++)
+        pthread_join(workers[i].thread, NULL);
 
-            /**
-             *  Acyclic graph found.
-             */
-            if (fb_size == 0 && ring_buf->best_fb_size == 0)
-            {
-                signal_handler(SIGINT);
-            }
-        }
+    for (i = 0; i < threads; i++)
+    {
+        free(workers[i].deque.tasks);
+        pthread_mutex_destroy(&workers[i].deque.lock);
     }
+    free(workers);
+    free(comp_best);
+    free(comp_edges);
+    graph_scc_destroy(scc);
     graph_destroy(g);
+    label_map_destroy(labels);
     exit(EXIT_SUCCESS);
 }
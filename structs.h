@@ -7,21 +7,46 @@
  * 
  * @details The structures header module provides the necessary libraries and structure
  * declarations used by the generator and supervisor programs. It also defines the
- * names of the semaphores, ring buffer and the various sizes of some structures.
+ * names of the ring buffer and the various sizes of some structures.
  */
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <signal.h>
+#include <pthread.h>
 
-#define FREE_SEM "/1426981_free"
-#define USED_SEM "/1426981_used"
-#define EXCL_SEM "/1426981_excl"
 #define RING_BUF "/1426981_ring"
+#define GRAPH_SHM "/1426981_graph"
 
-#define BSEARCH_PROMPT_SIZE 15 /**< size of outdegree after which to use a binary search */
-#define MAX_VIABLE_COUNT 8     /**< maximal size of feedback arc set to be considered */
-#define BUF_SIZE 8             /**< the size of the shared memory ring buffer */
+#define FASG_MAGIC "FASG"     /**< magic bytes at the start of a binary graph file */
+#define FASG_VERSION 1        /**< version of the binary graph file layout */
+#define RING_MAGIC 0x52534146 /**< "FASR" in little endian, marks a ring buffer which has been set up */
+#define RING_VERSION 7        /**< version of the shared memory ring buffer layout */
+
+#define BSEARCH_PROMPT_SIZE 15    /**< size of outdegree after which to use a binary search */
+#define PARSE_MIN_CHUNK (1 << 22) /**< minimal number of input bytes per parser thread */
+#define PARSE_MAX_THREADS 64      /**< maximal number of parser threads */
+#define RNG_BATCH 64              /**< number of random swap positions drawn at once when shuffling */
+#define SEARCH_MAX_THREADS 1024   /**< maximal number of search threads of a generator */
+#define EXACT_MAX_VERTICES 16     /**< components of up to this many vertices are solved exactly */
+#define TASK_SPLIT_VERTICES 256   /**< a component gets another restart task for every so many vertices */
+#define TASK_WORK 65536           /**< number of vertices and edges a restart task evaluates before it is rescheduled */
+#define SEARCH_PARK_MS 100        /**< milliseconds a search thread without a task parks at most before it looks again */
+#define SLOT_EDGES 64             /**< number of feedback arc set edges per ring buffer slot */
+#define BUF_SIZE 8                /**< default number of slots of a generator channel */
+#define RING_MIN_SLOTS 1          /**< minimal number of slots of a generator channel */
+#define RING_MAX_SLOTS (1 << 20)  /**< maximal number of slots of a generator channel */
+#define CHANNELS 64               /**< default number of generator channels, i.e. of concurrent generators */
+#define MAX_CHANNELS 4096         /**< maximal number of generator channels */
+#define CACHE_LINE 64             /**< size of a cache line, shared counters are kept on lines of their own */
+#define RING_SPINS 64             /**< number of busy polls of the ring buffer before yielding the processor */
+#define RING_SPIN_MIN_NS 2000     /**< shortest time the supervisor polls an idle ring buffer before it parks */
+#define RING_SPIN_MAX_NS 200000   /**< longest time the supervisor polls an idle ring buffer before it parks */
+#define RING_IDLE_WEIGHT 8        /**< a new idle time counts 1/RING_IDLE_WEIGHT in the moving average of idle times */
+#define RING_REAP_MS 500          /**< milliseconds between checks of the supervisor for channels of terminated generators */
+#define RING_PARK_MS 100          /**< milliseconds the supervisor parks at most before it polls the ring buffer again */
+#define BEST_EDGES 65536          /**< number of best feedback arc set edges kept when no graph is published */
 
 /** 
  * ---------------------------------------------------------------------------------
@@ -29,64 +54,376 @@
  * --------------------------------------------------------------------------------- 
  */
 
+/**
+ * A type to represent an external vertex label as given in the input.
+ */
+typedef uint64_t Label;
+
+/**
+ * A structure to represent a directed edge between two dense vertex indices.
+ */
+typedef struct Edge_s
+{
+  /*@{*/
+  int src;  /**< source vertex index  */
+  int trgt; /**< target vertex index  */
+  /*@}*/
+} Edge;
+
+/**
+ * A structure to represent a directed edge between two external vertex labels.
+ */
+typedef struct Label_edge_s
+{
+  /*@{*/
+  Label src;  /**< source vertex label  */
+  Label trgt; /**< target vertex label  */
+  /*@}*/
+} Label_edge;
+
+/**
+ * A structure to represent a growable list of directed edges between external vertex
+ * labels, as read from the input before the graph is built.
+ */
+typedef struct Edge_list_s
+{
+  /*@{*/
+  size_t num_e;      /**< the number of edges in the list */
+  size_t cap;        /**< capacity of the edges array     */
+  Label_edge *edges; /**< an array of Label_edge structs  */
+  /*@}*/
+} Edge_list;
+
+/**
+ * An enumeration of the supported graph input formats.
+ */
+typedef enum Graph_format_e
+{
+  /*@{*/
+  FORMAT_AUTO,   /**< detect a binary graph file, edge list or DIMACS */
+  FORMAT_EDGES,  /**< one <source>-<target> or <source> <target> edge per line */
+  FORMAT_DIMACS, /**< DIMACS style "a <source> <target>" arc lines */
+  FORMAT_METIS,  /**< METIS adjacency lists, line i lists the successors of vertex i */
+  FORMAT_FASG    /**< binary graph file, see Fasg_header */
+  /*@}*/
+} Graph_format;
+
+/**
+ * A structure to represent the state of a line based graph input parser.
+ */
+typedef struct Input_parser_s
+{
+  /*@{*/
+  Graph_format fmt;  /**< format of the input, FORMAT_AUTO until detected */
+  bool metis_header; /**< whether the METIS header has been read          */
+  Label metis_n;     /**< number of METIS vertices                        */
+  Label metis_fmt;   /**< METIS fmt field, announcing sizes and weights   */
+  Label metis_ncon;  /**< number of METIS vertex weights                  */
+  Label vertex;      /**< the METIS vertex of the last adjacency line     */
+  /*@}*/
+} Input_parser;
+
+/**
+ * A structure to represent a chunk of a mapped graph input parsed by one thread.
+ */
+typedef struct Parse_chunk_s
+{
+  /*@{*/
+  Graph_format fmt;  /**< format of the input                          */
+  const char *begin; /**< first character of the chunk                 */
+  const char *end;   /**< pointer past the last character of the chunk */
+  const char *error; /**< first malformed line, NULL if there is none  */
+  Edge_list list;    /**< edges parsed from the chunk                  */
+  /*@}*/
+} Parse_chunk;
+
+/**
+ * A structure to represent the statistics of reading a graph input.
+ */
+typedef struct Input_stats_s
+{
+  /*@{*/
+  size_t bytes; /**< number of bytes read        */
+  int threads;  /**< number of parser threads    */
+  double ms;    /**< time spent in milliseconds  */
+  /*@}*/
+} Input_stats;
+
+/**
+ * A structure to represent the mapping between external vertex labels and the dense
+ * vertex indices 0..n-1 which are used by the graph. Vertex i has the label labels[i],
+ * the labels are sorted in ascending order.
+ */
+typedef struct Label_map_s
+{
+  /*@{*/
+  int n;          /**< the number of distinct labels             */
+  bool is_mapped; /**< whether labels points into a mapped file  */
+  Label *labels;  /**< the sorted distinct labels                */
+  /*@}*/
+} Label_map;
+
 /**
  * A structure to represent a directed graph.
  * Implementation based on suggestions from a Yale course in C involving directed graphs
- * computations. 
+ * computations. The successors are kept in compressed sparse row form: the successors of
+ * vertex u are targets[offsets[u]] up to targets[offsets[u + 1] - 1] in ascending order
+ * and without duplicates. Edges are staged in one contiguous array until the graph is
+ * finalized, after which it is immutable. A graph read from a binary graph file points
+ * into the read-only mapping of the file instead of owning its rows.
  */
 typedef struct Graph_s
 {
   /*@{*/
-  int V; /**< the number of vertices */
-  int E; /**< the number of edges    */
+  int V;           /**< the number of vertices                */
+  int E;           /**< the number of edges                   */
+  bool is_final;   /**< whether the graph has been finalized  */
+  int cap;         /**< capacity of the staged edges array    */
+  Edge *staged;    /**< edges added before finalization       */
+  int *offsets;    /**< V + 1 offsets into the targets array  */
+  int *targets;    /**< E successor vertices grouped by source */
+  int max_out;     /**< the maximal out degree of a vertex    */
+  int max_in;      /**< the maximal in degree of a vertex     */
+  int dup_edges;   /**< number of duplicate edges dropped     */
+  void *mapping;   /**< mapped graph file, NULL if not mapped */
+  size_t map_size; /**< size of the mapped graph file         */
   /*@}*/
-
-  /**
-   *  A structure holding the successors list.
-   */
-  struct successors
-  {
-    /*@{*/
-    int d;          /**< number of successors     */
-    int len;        /**< array size               */
-    bool is_sorted; /**< whether array is sorted  */
-    int list[1];    /**< list os successor vert.  */
-    /*@}*/
-  } * alist[1];
 } * Graph_ptr;
 
 /**
- * A structure to represent a directed edge.
+ * A structure to represent the strongly connected components of a graph which have more
+ * than one vertex. Only edges inside such a component lie on a cycle and can belong to
+ * a minimal feedback arc set, the vertices of all other components are dropped.
  */
-typedef struct Edge_s
+typedef struct Graph_scc_s
 {
   /*@{*/
-  int src;  /**< source vertex label  */
-  int trgt; /**< target vertex label  */
+  int count;         /**< number of components with more than one vertex              */
+  int size;          /**< number of vertices in those components                      */
+  int *offsets;      /**< count + 1 offsets into the vertices array                   */
+  int *vertices;     /**< the vertices of the components, grouped by component        */
+  int *edge_offsets; /**< count + 1 prefix sums of the edges inside the components    */
+  int *comp;         /**< the component of each of the V vertices, -1 if it's dropped */
   /*@}*/
-} Edge;
+} Graph_scc;
 
 /**
- *  A structure to represent a feedback arc set.
+ * A structure to represent the header of a binary graph file. The header is followed
+ * by the V labels of the vertices (Label), the V + 1 row offsets (int32) and the E
+ * targets (int32) of the finalized graph, at the given byte offsets from the start of
+ * the file. All values are stored in host byte order.
+ */
+typedef struct Fasg_header_s
+{
+  /*@{*/
+  char magic[4];        /**< FASG_MAGIC                               */
+  uint32_t version;     /**< FASG_VERSION                             */
+  uint64_t V;           /**< the number of vertices                   */
+  uint64_t E;           /**< the number of edges                      */
+  uint64_t fingerprint; /**< graph_fingerprint() of the graph         */
+  uint32_t max_out;     /**< the maximal out degree of a vertex       */
+  uint32_t max_in;      /**< the maximal in degree of a vertex        */
+  uint64_t labels_at;   /**< byte offset of the labels                */
+  uint64_t offsets_at;  /**< byte offset of the row offsets           */
+  uint64_t targets_at;  /**< byte offset of the targets               */
+  uint64_t size;        /**< total size of the file in bytes          */
+  /*@}*/
+} Fasg_header;
+
+/**
+ *  A structure to represent a part of a feedback arc set in one channel slot.
+ *  A feedback arc set of num_e edges is written to ceil(num_e / SLOT_EDGES) consecutive
+ *  slots, the slot holding edge 0 comes first. An empty set takes one slot.
  */
 typedef struct Fb_arc_set_s
 {
   /*@{*/
-  bool written;                 /**< has the feedback arc set already been written to the ring buffer */
-  int num_e;                    /**< number of edges in the feedback arc set */
-  Edge edges[MAX_VIABLE_COUNT]; /**< an array of Edge structs */
+  int writer;                   /**< process id of the generator which wrote the part */
+  int num_e;                    /**< number of edges in the whole feedback arc set */
+  int first;                    /**< index of the first edge of this slot within the feedback arc set */
+  int count;                    /**< number of edges held by this slot */
+  Label_edge edges[SLOT_EDGES]; /**< an array of Label_edge structs */
   /*@}*/
 } Fb_arc_set;
 
 /**
- *  A structure to represent a shared memory ring buffer.
+ *  A structure to represent the mailbox of a generator, which holds its best feedback
+ *  arc set until all of its parts have been written to the ring buffer. A better set
+ *  found meanwhile waits as the next set, replacing any set which waited before.
+ */
+typedef struct Fb_mailbox_s
+{
+  /*@{*/
+  bool pending;   /**< whether the mailbox holds a set which hasn't been written completely */
+  int num_e;      /**< number of edges in the feedback arc set                            */
+  int first;      /**< index of the first edge which hasn't been written yet              */
+  Edge *edges;    /**< an array of Edge structs                                           */
+  bool has_next;  /**< whether a better set waits to be written next                      */
+  int next_num_e; /**< number of edges in the next feedback arc set                       */
+  Edge *next;     /**< an array of Edge structs of the next set                           */
+  /*@}*/
+} Fb_mailbox;
+
+/**
+ *  A structure to represent the state of a xoshiro256** random number generator.
+ */
+typedef struct Rng_s
+{
+  /*@{*/
+  uint64_t s[4]; /**< the 256 bit state, never all zero */
+  /*@}*/
+} Rng;
+
+/**
+ *  A structure to represent a search task of a generator. Small components are solved
+ *  exactly by a single task, large ones are searched by random restarts in as many tasks
+ *  as they are split into.
+ */
+typedef struct Search_task_s
+{
+  /*@{*/
+  int comp;   /**< the component to be searched                         */
+  int rounds; /**< number of orderings a restart task evaluates per run */
+  bool exact; /**< whether the component is solved exactly               */
+  /*@}*/
+} Search_task;
+
+/**
+ *  A structure to represent the tasks queued at a search thread. The thread takes the
+ *  task queued first and queues it again at the end after running it, other threads
+ *  steal the one queued last once they ran out of tasks of their own.
+ */
+typedef struct Task_deque_s
+{
+  /*@{*/
+  pthread_mutex_t lock; /**< lock of the deque                   */
+  Search_task *tasks;   /**< circular array of the tasks         */
+  int cap;              /**< capacity of the tasks array         */
+  int head;             /**< position of the task queued first   */
+  int size;             /**< number of tasks queued              */
+  /*@}*/
+} Task_deque;
+
+/**
+ *  A structure to represent a search thread of a generator. All threads share the graph,
+ *  the best fb arc sets of the components and the submission path of the generator.
+ */
+typedef struct Search_worker_s
+{
+  /*@{*/
+  pthread_t thread; /**< the thread running the search             */
+  int id;           /**< index of the thread                       */
+  Rng rng;          /**< the random number generator of the thread */
+  Task_deque deque; /**< the tasks queued at the thread            */
+  /*@}*/
+} Search_worker;
+
+/**
+ *  A structure to represent a feedback arc set which the supervisor reassembles from
+ *  the parts read from one channel.
+ */
+typedef struct Fb_assembly_s
+{
+  /*@{*/
+  int writer;        /**< process id of the generator, 0 if unused       */
+  int num_e;         /**< number of edges in the feedback arc set        */
+  int size;          /**< number of edges read so far, -1 if dropped     */
+  int cap;           /**< capacity of the edges array                    */
+  Label_edge *edges; /**< an array of Label_edge structs                 */
+  int orphan;        /**< terminated owner of the channel, 0 if none     */
+  /*@}*/
+} Fb_assembly;
+
+/**
+ *  A structure to represent the header at the start of the shared memory ring buffer,
+ *  against which generators check the layout before they map the slots. The magic is
+ *  written last, once the supervisor has set up the whole buffer.
+ */
+typedef struct Ring_header_s
+{
+  /*@{*/
+  uint32_t magic;     /**< RING_MAGIC                                  */
+  uint32_t version;   /**< RING_VERSION                                */
+  uint32_t channels;  /**< the number of generator channels            */
+  uint32_t slots;     /**< the number of slots of every channel        */
+  uint32_t slot_size; /**< the size of a slot in bytes                 */
+  uint32_t best_e;    /**< capacity of the best edges array            */
+  uint32_t best_v;    /**< capacity of the best ordering array         */
+  uint32_t owner;     /**< process id of the supervisor                */
+  uint64_t size;      /**< total size of the shared memory in bytes    */
+  /*@}*/
+} Ring_header;
+
+/**
+ *  A structure to represent the backoff of the supervisor polling an idle ring buffer.
+ *  The time it polls before it parks follows the moving average of the idle times, so
+ *  that it spins through short gaps between arrivals and parks right away on long ones.
+ */
+typedef struct Ring_backoff_s
+{
+  /*@{*/
+  int polls;           /**< number of unsuccessful polls since the ring buffer became idle */
+  uint64_t idle_since; /**< time at which the ring buffer became idle in ns             */
+  uint64_t idle_avg;   /**< moving average of the idle times in ns                      */
+  uint64_t window;     /**< time to poll before parking in ns                           */
+  /*@}*/
+} Ring_backoff;
+
+/**
+ *  A structure to represent the register of the best feedback arc set in the shared
+ *  memory, which the supervisor is the only one to write. Its edges and the vertex
+ *  ordering without backward edges follow the channels, as far as they
+ *  fit into the capacities of the header. The register is guarded by a sequence lock:
+ *  seq is odd while the supervisor writes, readers retry until they read the same even
+ *  seq before and after copying the register.
+ */
+typedef struct Best_register_s
+{
+  /*@{*/
+  uint64_t seq; /**< sequence number of the register                         */
+  int num_e;    /**< number of edges of the best set, INT_MAX if none yet    */
+  int stored_e; /**< number of its edges stored, less if they didn't fit     */
+  int stored_v; /**< number of vertices of its ordering stored, 0 if unknown */
+  /*@}*/
+} Best_register;
+
+/**
+ *  A structure to represent the channel of one generator, a single producer single
+ *  consumer ring of slots. The generator is the only one to advance head, the supervisor
+ *  the only one to advance tail. Both counters only ever grow and are reduced modulo the
+ *  slot count to index the slots. A generator registers the channel by claiming its
+ *  owner and then records its start time, which tells it apart from a later process with
+ *  the same process id. The counters carry on from where the previous owner left them.
+ */
+typedef struct Channel_s
+{
+  /*@{*/
+  int owner __attribute__((aligned(CACHE_LINE)));         /**< process id of the generator, 0 if free */
+  uint64_t started;                                       /**< start time of the generator, 0 if unknown */
+  uint64_t head __attribute__((aligned(CACHE_LINE)));     /**< the next position to be written by the generator */
+  uint64_t tail __attribute__((aligned(CACHE_LINE)));     /**< the next position to be read by the supervisor */
+  Fb_arc_set sets[] __attribute__((aligned(CACHE_LINE))); /**< an array of header.slots feedback arc set parts */
+  /*@}*/
+} Channel;
+
+/**
+ *  A structure to represent the shared memory of the supervisor and the generators. It
+ *  is followed by header.channels channels, then by the edges and ordering of the best
+ *  register.
  */
 typedef struct Ring_buffer_s
 {
   /*@{*/
-  bool acyclic; /**< whether the feedback arc set has found an acyclic solution */
+  Ring_header header;                                /**< layout of the shared memory */
+  bool acyclic __attribute__((aligned(CACHE_LINE))); /**< whether the feedback arc set has found an acyclic solution */
   volatile sig_atomic_t quit;
-  int best_fb_size;          /**< the current best feedback arc set size written to the buffer */
-  Fb_arc_set sets[BUF_SIZE]; /**< an array of feedback arc sets */
+  bool graph_shared;          /**< whether the supervisor published the graph in GRAPH_SHM */
+  uint64_t graph_fingerprint; /**< fingerprint of the graph all generators work on, 0 if none yet */
+  uint64_t seed;              /**< master seed of the run, from which the random number streams derive */
+  uint64_t streams;           /**< number of random number streams handed out to generators */
+  int bound __attribute__((aligned(CACHE_LINE)));          /**< size of the best set written to a channel completely */
+  uint32_t wake __attribute__((aligned(CACHE_LINE)));      /**< futex word of the supervisor, incremented by every wakeup */
+  int parked;                                              /**< whether the supervisor waits on the futex word */
+  Best_register best __attribute__((aligned(CACHE_LINE))); /**< the best feedback arc set found by the supervisor */
   /*@}*/
 } Buffer;
@@ -13,8 +13,13 @@
  * the supervisor and all generators monitor constantly. The termination of the 
  * supervisor is preceeded by closing and unlinking all shared resources.
  * 
- * USAGE: The supervisor does not take any arguments.
- * supervisor
+ * USAGE: The supervisor optionally takes a graph file ("-" denoting stdin) in the given
+ * format, which it publishes in shared memory for the generators to attach to, the
+ * number of generator channels, the number of slots of every channel and the master
+ * seed of the random number streams of the generators, which makes runs reproducible.
+ * With --query, it prints the best solution of the running supervisor instead.
+ * supervisor [--channels N] [--ring-slots N] [--seed S] [-t FORMAT] [-f FILE]
+ * supervisor --query
  */
 
 #include "fb_arc_set.h"
@@ -28,36 +33,66 @@ static int shm_buf_fd;
 static Buffer *ring_buf;
 
 /**
- * @brief Definition of the three semaphores needed for the fb_arc_set assignment.
+ * @brief Whether the graph has been published in the shared memory object GRAPH_SHM.
  */
-static sem_t *excl_sem;
-static sem_t *used_sem;
-static sem_t *free_sem;
+static bool graph_published = false;
+
+/**
+ * @brief The published graph and its labels, NULL if no graph was given, as well as the
+ * buffers of the ordering of the best solution.
+ */
+static Graph_ptr graph = NULL;
+static Label_map *graph_labels = NULL;
+static Edge *best_removed = NULL;
+static int *best_order = NULL;
+static Label *best_labels = NULL;
+
+/**
+ * @brief The feedback arc sets being reassembled from the channels, one for every channel.
+ */
+static Fb_assembly *assemblies = NULL;
+static int num_assemblies = 0;
+
+/**
+ * @brief The best solution of the parts drained since the last report, whose edges are
+ * swapped in from the assembly which completed it. Its size is INT_MAX if there is none.
+ */
+static Fb_assembly batch = {.writer = 0, .num_e = INT_MAX, .size = 0, .cap = 0, .edges = NULL, .orphan = 0};
 
 /**
  * Free before exit function.
  * @brief This function frees up the occupied shared ressources.
  * @details The function is used in the signal handling of SIGKILL and SIGTERM.
  * After such a signal has been sent by the user, this function ensures that the
- * supervisor closes and unlinks the free space, used space and mutual exclusion 
- * semaphores which they opened and also unmap and destroy the shared memory ring buffer.
+ * supervisor unmaps and destroys the shared memory ring buffer and the published graph.
  * @param none
  * @return none
  */
 static void free_before_exit(void)
 {
-	close_sem(free_sem);
-	sem_unlink(FREE_SEM);
+	if (ring_buf != NULL)
+	{
+		unmap_shm(ring_buf, ring_buf->header.size);
+		shm_unlink(RING_BUF);
+		close(shm_buf_fd);
+	}
 
-	close_sem(used_sem);
-	sem_unlink(USED_SEM);
+	if (graph_published)
+		shm_unlink(GRAPH_SHM);
 
-	close_sem(excl_sem);
-	sem_unlink(EXCL_SEM);
+	for (int i = 0; i < num_assemblies; i++)
+		free(assemblies[i].edges);
+	free(assemblies);
+	free(batch.edges);
 
-	unmap_shm(ring_buf, sizeof(Buffer));
-	shm_unlink(RING_BUF);
-	close(shm_buf_fd);
+	if (graph != NULL)
+	{
+		free(best_removed);
+		free(best_order);
+		free(best_labels);
+		label_map_destroy(graph_labels);
+		graph_destroy(graph);
+	}
 }
 
 /**
@@ -71,7 +106,8 @@ static void free_before_exit(void)
 void signal_handler(int signum)
 {
 	quit = 1;
-	ring_buf->quit = 1;
+	if (ring_buf != NULL)
+		ring_buf->quit = 1;
 }
 
 /**
@@ -91,12 +127,236 @@ void process_signal(void)
 	sigaction(SIGTERM, &sa, NULL);
 }
 
+/**
+ * Assemble solution function.
+ * @brief This function adds a part read from a channel to the solution of the channel.
+ * @details The parts of a feedback arc set follow each other in the channel of their
+ * generator, the first part of a set starts a new solution. Parts which don't continue
+ * the solution, e.g. the rest of a set whose generator was terminated while writing it
+ * and whose channel now belongs to another generator, are dropped, as are the parts of
+ * sets which aren't better than the best one so far, including the best one drained
+ * since the last report.
+ * @param sol The solution of the channel.
+ * @param part The slot of the channel holding the feedback arc set part.
+ * @return Returns true if the solution is complete, false otherwise.
+ */
+static bool assemble_solution(Fb_assembly *sol, const Fb_arc_set *part)
+{
+	/**
+	 * The part is read in place from the shared memory, its fields are read once and
+	 * checked, a faulty generator mustn't make the supervisor write out of bounds.
+	 */
+	int writer = part->writer;
+	int num_e = part->num_e;
+	int first = part->first;
+	int count = part->count;
+
+	if (num_e < 0 || first < 0 || count < 0 || count > SLOT_EDGES || count > num_e - first)
+	{
+		sol->size = -1;
+		return false;
+	}
+
+	if (first == 0)
+	{
+		sol->writer = writer;
+		sol->num_e = num_e;
+		sol->size = 0;
+	}
+	else if (writer != sol->writer || first != sol->size || num_e != sol->num_e)
+		return false;
+
+	if ((num_e >= best_size(ring_buf) || num_e >= batch.num_e) && num_e > 0)
+	{
+		sol->size = -1;
+		return false;
+	}
+
+	if (num_e > sol->cap)
+	{
+		sol->cap = num_e;
+		sol->edges = realloc(sol->edges, sizeof(Label_edge) * sol->cap);
+		if (sol->edges == NULL)
+		{
+			fprintf(stderr, "ERROR: Failed allocating the solution!\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	memcpy(sol->edges + first, part->edges, sizeof(Label_edge) * count);
+	sol->size += count;
+
+	return sol->size == sol->num_e;
+}
+
+/**
+ * Publish graph function.
+ * @brief This function publishes the graph in shared memory.
+ * @details The graph is stored as a binary graph image in the shared memory object
+ * GRAPH_SHM, which is then made read-only. Generators started without a graph of their
+ * own map the image instead of parsing and building the graph, so that all of them
+ * share a single copy of the same instance. The fingerprint of the graph is stored in
+ * the ring buffer, against which generators with a graph of their own are checked.
+ * @param none
+ * @return none
+ */
+static void publish_graph(void)
+{
+	size_t size = graph_fasg_size(graph);
+
+	int fd = create_shm(GRAPH_SHM);
+	graph_published = true;
+	truncate_shm(fd, size);
+
+	void *image = open_shm(fd, size);
+	ring_buf->graph_fingerprint = graph_store_fasg(graph, graph_labels, image);
+	unmap_shm(image, size);
+
+	/**
+	 * Generators open the graph read-only, writing to it isn't permitted anymore.
+	 */
+	if (fchmod(fd, 0400) == -1)
+	{
+		fprintf(stderr, "ERROR: Failed protecting the shared graph!\n");
+		exit(EXIT_FAILURE);
+	}
+	close(fd);
+
+	ring_buf->graph_shared = true;
+
+	int num_v = graph_vertex_count(graph);
+	int num_e = graph_edge_count(graph);
+	best_removed = malloc(sizeof(Edge) * (num_e > 0 ? num_e : 1));
+	best_order = malloc(sizeof(int) * (num_v > 0 ? num_v : 1));
+	best_labels = malloc(sizeof(Label) * (num_v > 0 ? num_v : 1));
+	if (best_removed == NULL || best_order == NULL || best_labels == NULL)
+	{
+		fprintf(stderr, "ERROR: Failed allocating the best ordering!\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+/**
+ * Publish best function.
+ * @brief This function stores a new best solution in the best register.
+ * @details If the graph is known, a vertex ordering in which only the edges of the
+ * solution point backwards is derived by sorting the graph without them topologically,
+ * and stored along with the solution. Generators and other observers read the register
+ * at any time without going through the ring buffer.
+ * @param sol The solution.
+ * @return none
+ */
+static void publish_best(Fb_assembly *sol)
+{
+	int num_v = 0;
+
+	if (graph != NULL)
+	{
+		int num_removed = 0;
+		for (int i = 0; i < sol->num_e; i++)
+		{
+			best_removed[num_removed].src = label_map_index(graph_labels, sol->edges[i].src);
+			best_removed[num_removed].trgt = label_map_index(graph_labels, sol->edges[i].trgt);
+			if (best_removed[num_removed].src >= 0 && best_removed[num_removed].trgt >= 0)
+				num_removed++;
+		}
+
+		/**
+		 * An ordering is only stored for an actual feedback arc set of the graph.
+		 */
+		num_v = graph_acyclic_order(graph, best_removed, num_removed, best_order);
+		if (num_removed < sol->num_e || num_v < graph_vertex_count(graph))
+			num_v = 0;
+
+		for (int i = 0; i < num_v; i++)
+			best_labels[i] = label_map_label(graph_labels, best_order[i]);
+	}
+
+	best_publish(ring_buf, sol->edges, sol->num_e, best_labels, num_v);
+}
+
+/**
+ * Query best function.
+ * @brief This function prints the best solution of a running supervisor.
+ * @details The ring buffer of the running supervisor is attached and a consistent copy
+ * of its best register is read, without blocking the supervisor. The best solution is
+ * printed along with its vertex ordering, if the supervisor knows the graph.
+ * @param prog Name of the program.
+ * @return none
+ */
+static void query_best(char *prog)
+{
+	int fd;
+	Best_register reg;
+	Buffer *buf = ring_attach(RING_BUF, &fd);
+	Label_edge *edges = malloc(sizeof(Label_edge) * (buf->header.best_e > 0 ? buf->header.best_e : 1));
+	Label *order = malloc(sizeof(Label) * (buf->header.best_v > 0 ? buf->header.best_v : 1));
+	if (edges == NULL || order == NULL)
+	{
+		fprintf(stderr, "ERROR: Failed allocating the best solution!\n");
+		exit(EXIT_FAILURE);
+	}
+
+	best_read(buf, edges, order, &reg);
+	if (reg.num_e == INT_MAX)
+	{
+		fprintf(stdout, "[%s] No solution yet\n", prog);
+	}
+	else
+	{
+		fprintf(stdout, "[%s] Best solution with %d edges:", prog, reg.num_e);
+		for (int i = 0; i < reg.stored_e; i++)
+			fprintf(stdout, " %" PRIu64 "-%" PRIu64, edges[i].src, edges[i].trgt);
+		if (reg.stored_e < reg.num_e)
+			fprintf(stdout, " (%d edges not stored)", reg.num_e - reg.stored_e);
+		fprintf(stdout, "\n");
+	}
+
+	if (reg.num_e != INT_MAX && reg.stored_v > 0)
+	{
+		fprintf(stdout, "[%s] Ordering:", prog);
+		for (int i = 0; i < reg.stored_v; i++)
+			fprintf(stdout, " %" PRIu64, order[i]);
+		fprintf(stdout, "\n");
+	}
+
+	free(edges);
+	free(order);
+	unmap_shm(buf, buf->header.size);
+	close(fd);
+}
+
+/**
+ * Parse count function.
+ * @brief This function parses a count given as an option argument.
+ * @param prog Name of the program.
+ * @param arg The option argument.
+ * @param what Name of the count for the error message.
+ * @param min Minimal value of the count.
+ * @param max Maximal value of the count.
+ * @return Returns the count, invalid counts are handled as a usage error.
+ */
+static long parse_count(char *prog, const char *arg, const char *what, long min, long max)
+{
+	char *end;
+	errno = 0;
+	long count = strtol(arg, &end, 10);
+
+	if (errno != 0 || end == arg || *end != '\0' || count < min || count > max)
+	{
+		fprintf(stderr, "[%s] ERROR: The number of %s must be between %ld and %ld!\n", prog, what, min, max);
+		usage(prog);
+	}
+	return count;
+}
+
 /**
  * Program entry point.
  * @brief This is the main program of the supervisor module.
  * @details The program performs all of the supervisor functions as described in the
  * task requirements. Initially, it checks that the supervisor program has been
- * called correctly, afterwards it sets up all shared memory objects and semaphores.
+ * called correctly, afterwards it sets up the shared memory ring buffer and publishes
+ * the graph if one was given.
  * The main tasks are performed in the program loop which monitors if the shared atomic
  * variable "quit" is set to true. The program makes sure that all of the feedback arc
  * sets written to the ring buffer are presented in the correct order and that no 
@@ -109,11 +369,73 @@ int main(int argc, char *argv[])
 {
 	char *prog = argv[0];
 
-	if (argc > 1)
+	int opt;
+	char *path = NULL;
+	long slots = BUF_SIZE;
+	long channels = CHANNELS;
+	uint64_t seed = 0;
+	bool seeded = false;
+	bool query = false;
+	char *end;
+	Graph_format fmt = FORMAT_AUTO;
+
+	static struct option long_opts[] = {
+		{"ring-slots", required_argument, NULL, 'r'},
+		{"channels", required_argument, NULL, 'c'},
+		{"seed", required_argument, NULL, 's'},
+		{"query", no_argument, NULL, 'q'},
+		{NULL, 0, NULL, 0}};
+
+	while ((opt = getopt_long(argc, argv, "f:t:", long_opts, NULL)) != -1)
+	{
+		switch (opt)
+		{
+		case 'r':
+			slots = parse_count(prog, optarg, "ring slots", RING_MIN_SLOTS, RING_MAX_SLOTS);
+			break;
+		case 'c':
+			channels = parse_count(prog, optarg, "channels", 1, MAX_CHANNELS);
+			break;
+		case 's':
+			errno = 0;
+			seed = strtoull(optarg, &end, 0);
+			if (errno != 0 || end == optarg || *end != '\0')
+			{
+				fprintf(stderr, "[%s] ERROR: The seed must be an unsigned 64 bit number!\n", prog);
+				usage(prog);
+			}
+			seeded = true;
+			break;
+		case 'q':
+			query = true;
+			break;
+		case 'f':
+			path = optarg;
+			break;
+		case 't':
+			if (!format_from_name(optarg, &fmt))
+				usage(prog);
+			break;
+		default:
+			usage(prog);
+		}
+	}
+
+	if (optind < argc)
 	{
 		usage(prog);
 	}
 
+	/**
+	 * A query only reads the shared memory of the running supervisor, which it must not
+	 * remove on exit.
+	 */
+	if (query)
+	{
+		query_best(prog);
+		exit(EXIT_SUCCESS);
+	}
+
 	if (atexit(free_before_exit) != 0)
 	{
 		fprintf(stderr, "ERROR: Free before exit function failed!\n");
@@ -125,69 +447,171 @@ int main(int argc, char *argv[])
 	/** 
 	 * Shared memory objects definitions
 	 */
-	shm_buf_fd = create_shm(RING_BUF);
-	truncate_shm(shm_buf_fd, BUF_SIZE);
-	ring_buf = (Buffer *)open_shm(shm_buf_fd, sizeof(Buffer));
+	if (path != NULL)
+	{
+		graph = graph_read(path, fmt, &graph_labels, NULL);
+	}
 
 	/**
-	 * Semaphore objects definitions
+	 * The best register holds a whole solution and its ordering if the graph is known.
 	 */
-	excl_sem = open_sem(EXCL_SEM, 1, 0);
-	used_sem = open_sem(USED_SEM, 0, 0);
-	free_sem = open_sem(FREE_SEM, BUF_SIZE, 0);
+	int best_e = graph != NULL ? graph_edge_count(graph) : BEST_EDGES;
+	int best_v = graph != NULL ? graph_vertex_count(graph) : 0;
+	size_t size = ring_size(channels, slots, best_e, best_v);
 
 	/**
-	 * Definition of fb arc set array and free/used counters
+	 * A supervisor killed by SIGKILL leaves its shared memory objects behind, they are
+	 * removed unless their supervisor is still running.
 	 */
-	Fb_arc_set fb_arc_set;
-	int free_space = 0;
-	int used_space = 0;
-	int read_from = 0;
+	if (ring_stale(RING_BUF))
+	{
+		shm_unlink(RING_BUF);
+		shm_unlink(GRAPH_SHM);
+		fprintf(stdout, "[%s] Removed the shared memory of a terminated supervisor\n", prog);
+	}
 
-	ring_buf->best_fb_size = INT16_MAX; /**< By default, consider the worst fb arc set possible */
+	shm_buf_fd = create_shm(RING_BUF);
+	truncate_shm(shm_buf_fd, size);
+	ring_buf = (Buffer *)open_shm(shm_buf_fd, size);
+	ring_reserve(ring_buf);
+	ring_buf->header.size = size;
 
-	while (quit != 1)
+	ring_buf->graph_shared = false;
+	ring_buf->graph_fingerprint = 0;
+
+	if (graph != NULL)
 	{
-		/**
-		 * Used in the creation/debugging stage. Is now obsolete.
-		 */
-		getval_sem(free_sem, &free_space);
-		getval_sem(used_sem, &used_space);
+		publish_graph();
+	}
 
-		wait_sem(used_sem); /**< Block the used_sem. */
+	/**
+	 * Generators refuse to attach to the ring buffer before it is initialized, hence they
+	 * always see the published graph.
+	 */
+	if (!seeded)
+	{
+		struct timespec now;
+		clock_gettime(CLOCK_REALTIME, &now);
+		seed = stream_seed((uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec, getpid());
+	}
+	ring_init(ring_buf, channels, slots, best_e, best_v, seed);
+	fprintf(stdout, "[%s] Seed %" PRIu64 "\n", prog, seed);
+
+	assemblies = calloc(channels, sizeof(Fb_assembly));
+	if (assemblies == NULL)
+	{
+		fprintf(stderr, "ERROR: Failed allocating the solutions!\n");
+		exit(EXIT_FAILURE);
+	}
+	num_assemblies = channels;
+
+	/**
+	 * Definition of the channel slot and backoff
+	 */
+	const Fb_arc_set *slot;
+	Fb_assembly *sol;
+	Ring_backoff backoff;
+	ring_backoff_init(&backoff);
+	struct timespec reaped;
+	clock_gettime(CLOCK_MONOTONIC, &reaped);
 
+	while (quit != 1)
+	{
 		/**
-		 * Find a position in the ring buffer which is already written to.
+		 * Channels of generators which were killed without releasing them are looked for
+		 * every RING_REAP_MS. They are reclaimed after the drain below, which reads the
+		 * parts the generators wrote before they died.
 		 */
-		while (ring_buf->sets[read_from].written == false)
+		if (elapsed_ms(&reaped) >= RING_REAP_MS)
 		{
-			read_from = (read_from + 1) % BUF_SIZE;
+			for (int c = 0; c < num_assemblies; c++)
+				assemblies[c].orphan = channel_orphaned(ring_channel(ring_buf, c));
+			clock_gettime(CLOCK_MONOTONIC, &reaped);
 		}
 
 		/**
-		 * Get the written fb arc set from the buffer and free it for overwriting.
+		 * Every wakeup drains all parts available. The channels are drained in turns, at
+		 * most one channel full of parts at a time, so that a busy generator doesn't hold
+		 * up the others, until a whole pass reads nothing. A part is assembled in place,
+		 * only then its slot is freed for overwriting. Only the best solution of the
+		 * batch is published and printed. If all channels are empty, they are polled
+		 * again after a backoff, in which the supervisor eventually parks until a
+		 * generator wakes it up.
 		 */
-		fb_arc_set = ring_buf->sets[read_from];
-		ring_buf->sets[read_from].written = false;
+		bool idle = true;
+		bool drained = false;
+		while (!drained && quit != 1)
+		{
+			drained = true;
+			for (int c = 0; c < num_assemblies && quit != 1; c++)
+			{
+				Channel *ch = ring_channel(ring_buf, c);
+				sol = &assemblies[c];
+
+				for (uint32_t n = 0; n < ring_buf->header.slots && (slot = channel_peek(ring_buf, ch)) != NULL; n++)
+				{
+					drained = false;
+					bool complete = assemble_solution(sol, slot);
+					channel_consume(ch);
+					if (!complete)
+						continue;
 
-		post_sem(free_sem); /**< Indicate that there is place for writing in the ring buffer. */
+					/**
+					 * Acyclic graph found.
+					 */
+					if (sol->num_e == 0)
+					{
+						publish_best(sol);
+						fprintf(stdout, "[%s] The graph is acyclic!\n", prog);
+						ring_buf->acyclic = true;
+						signal_handler(SIGTERM);
+						batch.num_e = INT_MAX;
+						break;
+					}
 
-		read_from = (read_from + 1) % BUF_SIZE;
+					/**
+					 * The edges of the better solution are swapped with those of the
+					 * batch, the assembly starts over with the next first part anyway.
+					 */
+					Label_edge *edges = batch.edges;
+					int cap = batch.cap;
+					batch = *sol;
+					sol->edges = edges;
+					sol->cap = cap;
+				}
+			}
+			if (!drained)
+				idle = false;
+		}
 
 		/**
-		 * Acyclic graph found.
+		 * A set a terminated generator left half-written is never completed, it is
+		 * dropped along with the channel.
 		 */
-		if (fb_arc_set.num_e == 0)
+		for (int c = 0; c < num_assemblies; c++)
 		{
-			fprintf(stdout, "[%s] The graph is acyclic!\n", prog);
-			ring_buf->acyclic = true;
-			signal_handler(SIGTERM);
+			sol = &assemblies[c];
+			if (sol->orphan == 0)
+				continue;
+
+			if (sol->size != sol->num_e)
+				sol->size = -1;
+			channel_reclaim(ring_channel(ring_buf, c), sol->orphan);
+			fprintf(stdout, "[%s] Reclaimed the channel of terminated generator %d\n", prog, sol->orphan);
+			sol->orphan = 0;
 		}
-		else if (fb_arc_set.num_e < ring_buf->best_fb_size)
+
+		if (batch.num_e < best_size(ring_buf))
 		{
-			ring_buf->best_fb_size = fb_arc_set.num_e;
-			print_solution(fb_arc_set.edges, prog, fb_arc_set.num_e);
+			publish_best(&batch);
+			print_solution(batch.edges, prog, batch.num_e, batch.writer);
 		}
+		batch.num_e = INT_MAX;
+
+		if (idle)
+			ring_backoff(ring_buf, &backoff);
+		else
+			ring_arrival(&backoff);
 	}
 	exit(EXIT_SUCCESS);
 }